@@ -0,0 +1,524 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include "execlib.hpp"
+
+
+//Benchmarks for execlib.
+//
+//Usage: benchmarks [max_thread_count [scale]]
+//
+//Each benchmark runs for thread counts 1, 2, 4, ... up to max_thread_count (default: hardware concurrency).
+//Results are printed as csv, one line per benchmark and thread count:
+//benchmark, threads, operations, seconds, operations per second, and p50/p99/p999 latency in nanoseconds.
+//The scale multiplies the number of operations of each benchmark (default: 1).
+
+
+using benchmark_clock = std::chrono::steady_clock;
+
+
+//returns the current time in nanoseconds
+static uint64_t now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(benchmark_clock::now().time_since_epoch()).count();
+}
+
+
+//result of a benchmark
+struct benchmark_result {
+    //number of operations
+    size_t operation_count = 0;
+
+    //total time
+    double seconds = 0;
+
+    //latency samples, in nanoseconds
+    std::vector<uint64_t> latencies;
+};
+
+
+//returns the given percentile of sorted samples
+static uint64_t percentile(const std::vector<uint64_t>& sorted_samples, double p) {
+    if (sorted_samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(sorted_samples.size() - 1, (size_t)(p * (double)sorted_samples.size()));
+    return sorted_samples[index];
+}
+
+
+//prints the result of a benchmark
+static void print_result(const char* name, size_t thread_count, benchmark_result& result) {
+    std::sort(result.latencies.begin(), result.latencies.end());
+    printf("%s,%zu,%zu,%.6f,%.0f,%llu,%llu,%llu\n",
+        name,
+        thread_count,
+        result.operation_count,
+        result.seconds,
+        result.seconds > 0 ? (double)result.operation_count / result.seconds : 0.0,
+        (unsigned long long)percentile(result.latencies, 0.50),
+        (unsigned long long)percentile(result.latencies, 0.99),
+        (unsigned long long)percentile(result.latencies, 0.999));
+    fflush(stdout);
+}
+
+
+//waits for the given number of operations to complete, executing pending jobs meanwhile
+static void wait_for(execlib::executor& executor, const std::atomic<size_t>& completed, size_t count) {
+    while (completed.load(std::memory_order_acquire) < count) {
+        if (!executor.execute_pending_job()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+//empty jobs submitted from the main thread; latency is from submission to execution
+static benchmark_result spawn_benchmark(size_t thread_count, size_t scale) {
+    const size_t job_count = 100000 * scale;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = job_count;
+    result.latencies.resize(job_count);
+    std::atomic<size_t> completed{ 0 };
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < job_count; ++i) {
+        executor.execute([&, i, submitted = now_ns()]() {
+            result.latencies[i] = now_ns() - submitted;
+            completed.fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_for(executor, completed, job_count);
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//fork-join fibonacci
+static uint64_t fib(execlib::executor& executor, unsigned n) {
+    if (n < 16) {
+        return n < 2 ? n : fib(executor, n - 1) + fib(executor, n - 2);
+    }
+    auto a = executor.execute(execlib::use_future, [&executor, n]() { return fib(executor, n - 1); });
+    const uint64_t b = fib(executor, n - 2);
+    return a.get() + b;
+}
+
+
+//fork-join recursion; latency is the time of each run
+static benchmark_result fib_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 10 * scale;
+    const unsigned n = 30;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count;
+    volatile uint64_t sink = 0;
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < run_count; ++i) {
+        const uint64_t run_start = now_ns();
+        sink = fib(executor, n);
+        result.latencies.push_back(now_ns() - run_start);
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+    (void)sink;
+
+    return result;
+}
+
+
+//busy work of the given number of steps
+static uint64_t busy_work(size_t step_count) {
+    uint64_t value = step_count;
+    for (size_t i = 0; i < step_count; ++i) {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return value;
+}
+
+
+//parallel_for over items of very uneven cost; latency is the time of each run
+static benchmark_result unbalanced_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 20 * scale;
+    const size_t item_count = 4096;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count * item_count;
+    std::vector<uint64_t> values(item_count);
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < run_count; ++i) {
+        const uint64_t run_start = now_ns();
+        execlib::parallel_for(executor, size_t(0), item_count, size_t(16), [&](size_t index) {
+            //one item in 64 costs 1000 times more than the others
+            values[index] = busy_work(index % 64 == 0 ? 100000 : 100);
+        });
+        result.latencies.push_back(now_ns() - run_start);
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//returns random strings of the given length
+static std::vector<std::string> prepare_test_data(size_t count, size_t length) {
+    std::default_random_engine re(0);
+    std::uniform_int_distribution<int> dist(' ', '~');
+
+    std::vector<std::string> result;
+
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back();
+        for (size_t j = 0; j < length; ++j) {
+            result.back().push_back((char)dist(re));
+        }
+    }
+
+    return result;
+}
+
+
+//creates all combinations of the characters of a string
+static void create_all_combinations(const std::string& in_str, std::string& out_str, size_t position = 0) {
+    if (position < in_str.size()) {
+        for (size_t i = 0; i < in_str.size(); ++i) {
+            out_str[position] = in_str[i];
+            create_all_combinations(in_str, out_str, position + 1);
+        }
+    }
+}
+
+
+//all combinations of random strings, one job per string; latency is the time of each run
+static benchmark_result combinations_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 5 * scale;
+    const auto test_data = prepare_test_data(256, 6);
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count * test_data.size();
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < run_count; ++i) {
+        const uint64_t run_start = now_ns();
+        execlib::parallel_for(executor, test_data.begin(), test_data.end(), size_t(1), [](const std::string& in_str) {
+            std::string out_str(in_str);
+            create_all_combinations(in_str, out_str);
+        });
+        result.latencies.push_back(now_ns() - run_start);
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//parallel_sort of random strings; latency is the time of each run
+static benchmark_result sort_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 5 * scale;
+    const auto test_data = prepare_test_data(200000, 16);
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count * test_data.size();
+    std::vector<std::string> values;
+
+    double seconds = 0;
+    for (size_t i = 0; i < run_count; ++i) {
+        values = test_data;
+        const uint64_t run_start = now_ns();
+        execlib::parallel_sort(executor, values.begin(), values.end());
+        const uint64_t run_time = now_ns() - run_start;
+        result.latencies.push_back(run_time);
+        seconds += (double)run_time * 1e-9;
+    }
+    result.seconds = seconds;
+
+    return result;
+}
+
+
+//returns the FNV-1a hash of a string
+static uint64_t hash_string(const std::string& str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char c : str) {
+        hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//parallel_transform of random strings to their hashes; latency is the time of each run
+static benchmark_result transform_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 20 * scale;
+    const auto test_data = prepare_test_data(200000, 64);
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count * test_data.size();
+    std::vector<uint64_t> hashes(test_data.size());
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < run_count; ++i) {
+        const uint64_t run_start = now_ns();
+        execlib::parallel_transform(executor, test_data.begin(), test_data.end(), hashes.begin(), hash_string);
+        result.latencies.push_back(now_ns() - run_start);
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//parallel_scan of the hashes of random strings; latency is the time of each run
+static benchmark_result scan_benchmark(size_t thread_count, size_t scale) {
+    const size_t run_count = 100 * scale;
+    const auto test_data = prepare_test_data(200000, 64);
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = run_count * test_data.size();
+    std::vector<uint64_t> hashes(test_data.size());
+    std::transform(test_data.begin(), test_data.end(), hashes.begin(), hash_string);
+    std::vector<uint64_t> prefixes(hashes.size());
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < run_count; ++i) {
+        const uint64_t run_start = now_ns();
+        execlib::parallel_scan(executor, hashes.begin(), hashes.end(), prefixes.begin(), uint64_t(0), [](uint64_t a, uint64_t b) { return a + b; });
+        result.latencies.push_back(now_ns() - run_start);
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//empty jobs submitted concurrently from several threads that are not worker threads;
+//latency is from submission to execution
+static benchmark_result foreign_producer_benchmark(size_t thread_count, size_t scale) {
+    const size_t producer_count = 4;
+    const size_t job_count = 25000 * scale;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = producer_count * job_count;
+    result.latencies.resize(producer_count * job_count);
+    std::atomic<size_t> completed{ 0 };
+    std::vector<std::thread> producers;
+
+    const uint64_t start = now_ns();
+    for (size_t p = 0; p < producer_count; ++p) {
+        producers.emplace_back([&, p]() {
+            for (size_t i = p * job_count, end = i + job_count; i < end; ++i) {
+                executor.execute([&, i, submitted = now_ns()]() {
+                    result.latencies[i] = now_ns() - submitted;
+                    completed.fetch_add(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    wait_for(executor, completed, result.operation_count);
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//empty jobs submitted from jobs; latency is from submission to execution
+static benchmark_result nested_benchmark(size_t thread_count, size_t scale) {
+    const size_t parent_count = 100;
+    const size_t child_count = 1000 * scale;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = parent_count * child_count;
+    result.latencies.resize(parent_count * child_count);
+    std::atomic<size_t> completed{ 0 };
+
+    const uint64_t start = now_ns();
+    for (size_t p = 0; p < parent_count; ++p) {
+        executor.execute([&, p]() {
+            for (size_t i = p * child_count, end = i + child_count; i < end; ++i) {
+                executor.execute([&, i, submitted = now_ns()]() {
+                    result.latencies[i] = now_ns() - submitted;
+                    completed.fetch_add(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    wait_for(executor, completed, result.operation_count);
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//jobs that release their worker thread; latency is from submission to the end of the release
+static benchmark_result release_churn_benchmark(size_t thread_count, size_t scale) {
+    const size_t job_count = 200 * scale;
+    execlib::executor executor(thread_count);
+    benchmark_result result;
+    result.operation_count = job_count;
+    result.latencies.resize(job_count);
+    std::atomic<size_t> completed{ 0 };
+
+    const uint64_t start = now_ns();
+    for (size_t i = 0; i < job_count; ++i) {
+        executor.execute([&, i, submitted = now_ns()]() {
+            execlib::executor::release_current_worker_thread();
+            result.latencies[i] = now_ns() - submitted;
+            completed.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    //the jobs must run on worker threads, so the main thread does not execute pending jobs
+    while (completed.load(std::memory_order_acquire) < job_count) {
+        std::this_thread::yield();
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//jobs that update shared state, serialized by a strand; latency is from the job's submission
+//to the strand until its update
+static benchmark_result strand_benchmark(size_t thread_count, size_t scale) {
+    const size_t job_count = 100000 * scale;
+    execlib::executor executor(thread_count);
+    execlib::strand strand(executor);
+    uint64_t shared_value = 0;
+    benchmark_result result;
+    result.operation_count = job_count;
+    result.latencies.resize(job_count);
+    std::atomic<size_t> completed{ 0 };
+
+    const uint64_t start = now_ns();
+    executor.execute_n(job_count, [&](size_t i) {
+        strand.execute([&, i, submitted = now_ns()]() {
+            ++shared_value;
+            result.latencies[i] = now_ns() - submitted;
+            completed.fetch_add(1, std::memory_order_release);
+        });
+    });
+    wait_for(executor, completed, job_count);
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//jobs that update shared state, serialized by a mutex, as a baseline for the strand;
+//latency is from locking the mutex until the update
+static benchmark_result mutex_job_benchmark(size_t thread_count, size_t scale) {
+    const size_t job_count = 100000 * scale;
+    execlib::executor executor(thread_count);
+    execlib::deadlock_free_mutex mutex;
+    uint64_t shared_value = 0;
+    benchmark_result result;
+    result.operation_count = job_count;
+    result.latencies.resize(job_count);
+    std::atomic<size_t> completed{ 0 };
+
+    const uint64_t start = now_ns();
+    executor.execute_n(job_count, [&](size_t i) {
+        const uint64_t lock_start = now_ns();
+        std::lock_guard lock(mutex);
+        ++shared_value;
+        result.latencies[i] = now_ns() - lock_start;
+        completed.fetch_add(1, std::memory_order_release);
+    });
+    wait_for(executor, completed, job_count);
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//threads that lock two shared mutexes in opposite orders; latency is the time to lock both mutexes
+template <class Mutex> static benchmark_result mutex_benchmark(size_t thread_count, size_t scale) {
+    const size_t lock_count = 20000 * scale;
+    Mutex mutexA;
+    Mutex mutexB;
+    uint64_t shared_value = 0;
+    benchmark_result result;
+    result.operation_count = thread_count * lock_count;
+    result.latencies.resize(thread_count * lock_count);
+    std::vector<std::thread> threads;
+
+    const uint64_t start = now_ns();
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            //std::mutex would deadlock on opposite locking orders, so it uses the same order in all threads
+            const bool reverse = std::is_same_v<Mutex, execlib::deadlock_free_mutex> && t % 2 == 1;
+            Mutex& first = reverse ? mutexB : mutexA;
+            Mutex& second = reverse ? mutexA : mutexB;
+            for (size_t i = t * lock_count, end = i + lock_count; i < end; ++i) {
+                const uint64_t lock_start = now_ns();
+                std::lock_guard lock_first(first);
+                std::lock_guard lock_second(second);
+                result.latencies[i] = now_ns() - lock_start;
+                ++shared_value;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    result.seconds = (double)(now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+
+//a benchmark
+struct benchmark {
+    const char* name;
+    benchmark_result (*func)(size_t thread_count, size_t scale);
+};
+
+
+int main(int argc, char* argv[]) {
+    const size_t max_thread_count = std::max<size_t>(1, argc > 1 ? (size_t)std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency());
+    const size_t scale = argc > 2 ? std::max<size_t>(1, (size_t)std::strtoul(argv[2], nullptr, 10)) : 1;
+
+    const benchmark benchmarks[] = {
+        { "spawn", spawn_benchmark },
+        { "fib", fib_benchmark },
+        { "unbalanced", unbalanced_benchmark },
+        { "combinations", combinations_benchmark },
+        { "sort", sort_benchmark },
+        { "transform", transform_benchmark },
+        { "scan", scan_benchmark },
+        { "foreign_producer", foreign_producer_benchmark },
+        { "nested", nested_benchmark },
+        { "release_churn", release_churn_benchmark },
+        { "strand", strand_benchmark },
+        { "mutex_job", mutex_job_benchmark },
+        { "deadlock_free_mutex", mutex_benchmark<execlib::deadlock_free_mutex> },
+        { "std_mutex", mutex_benchmark<std::mutex> }
+    };
+
+    printf("benchmark,threads,operations,seconds,operations_per_second,p50_ns,p99_ns,p999_ns\n");
+
+    for (const benchmark& b : benchmarks) {
+        //powers of two, then the maximum
+        for (size_t thread_count = 1;; thread_count = std::min(thread_count * 2, max_thread_count)) {
+            benchmark_result result = b.func(thread_count, scale);
+            print_result(b.name, thread_count, result);
+            if (thread_count == max_thread_count) {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
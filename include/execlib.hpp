@@ -3,8 +3,21 @@
 
 
 #include "execlib/executor.hpp"
+#include "execlib/future.hpp"
+#include "execlib/task_group.hpp"
+#include "execlib/task_graph.hpp"
+#include "execlib/strand.hpp"
 #include "execlib/counter.hpp"
+#include "execlib/atomic_counter.hpp"
+#include "execlib/latch.hpp"
+#include "execlib/barrier.hpp"
 #include "execlib/deadlock_free_mutex.hpp"
+#include "execlib/parallel_for.hpp"
+#include "execlib/parallel_reduce.hpp"
+#include "execlib/parallel_transform.hpp"
+#include "execlib/parallel_scan.hpp"
+#include "execlib/parallel_sort.hpp"
+#include "execlib/coroutine.hpp"
 
 
 #endif //EXECLIB_HPP
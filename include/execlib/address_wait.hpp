@@ -0,0 +1,41 @@
+#ifndef EXECLIB_ADDRESS_WAIT_HPP
+#define EXECLIB_ADDRESS_WAIT_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+
+namespace execlib {
+
+
+    /**
+     * Blocks the current thread while a word has the given value, or until the timeout expires.
+     * It may return spuriously; callers check their condition again.
+     * Uses a futex on Linux, WaitOnAddress on Windows; elsewhere, a table of condition variables.
+     * @param word word to wait on.
+     * @param value the value the word must have for the thread to block.
+     * @param timeout maximum time to block.
+     */
+    void wait_on_address(const std::atomic<uint32_t>& word, uint32_t value, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+
+
+    /**
+     * Wakes up one thread blocked in wait_on_address for the given word.
+     * @param word word threads wait on.
+     */
+    void wake_by_address_one(const std::atomic<uint32_t>& word);
+
+
+    /**
+     * Wakes up all threads blocked in wait_on_address for the given word.
+     * @param word word threads wait on.
+     */
+    void wake_by_address_all(const std::atomic<uint32_t>& word);
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_ADDRESS_WAIT_HPP
@@ -0,0 +1,218 @@
+#ifndef EXECLIB_ATOMIC_COUNTER_HPP
+#define EXECLIB_ATOMIC_COUNTER_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "counter.hpp"
+#include "address_wait.hpp"
+#include "wait_internals.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * A synchronized counter, like counter, which blocks on the address of a word 
+     * (a futex on Linux) instead of on a mutex and a condition variable.
+     * 
+     * It keeps the number of waiting threads, therefore notifying when there are no waiters
+     * costs a few atomic operations, and no system call.
+     * 
+     * @param T type of counter value.
+     * @param P type of predicate to use for testing if an event should be reported.
+     */
+    template <class T, class P = is_counter_zero<T>> class atomic_counter {
+    public:
+        /**
+         * The default constructor.
+         * @param initial_value initial value.
+         */
+        atomic_counter(T&& initial_value = T()) :
+            m_value(std::move(initial_value))
+        {
+        }
+
+        /**
+         * The constructor from value and predicate.
+         * @param initial_value initial value.
+         * @param pred predicate.
+         */
+        atomic_counter(T&& initial_value, P&& pred) :
+            m_value(std::move(initial_value)),
+            m_pred(std::move(pred))
+        {
+        }
+
+        /**
+         * Returns the value.
+         * @return the value.
+         */
+        operator T () const {
+            return m_value;
+        }
+
+        /**
+         * Returns the value.
+         * @return the value.
+         */
+        T get() const {
+            return m_value;
+        }
+
+        /**
+         * Atomically increments the counter.
+         */
+        void increment(const T& value = (T)1) {
+            m_value.fetch_add(value, std::memory_order_release);
+        }
+
+        /**
+         * Atomically decrements the counter.
+         */
+        void decrement(const T& value = (T)1) {
+            m_value.fetch_sub(value, std::memory_order_release);
+        }
+
+        /**
+         * Atomically increments the counter.
+         */
+        atomic_counter& operator ++ () {
+            increment();
+            return *this;
+        }
+
+        /**
+         * Atomically decrements the counter.
+         */
+        atomic_counter& operator -- () {
+            decrement();
+            return *this;
+        }
+
+        /**
+         * Atomically adds a value to the counter.
+         */
+        atomic_counter& operator += (const T& value) {
+            increment(value);
+            return *this;
+        }
+
+        /**
+         * Atomically subtracts a value from the counter.
+         */
+        atomic_counter& operator -= (const T& value) {
+            decrement(value);
+            return *this;
+        }
+
+        /**
+         * Atomically increments the counter.
+         * It notifies one thread if the predicate returns true.
+         */
+        void increment_and_notify_one() {
+            update_and_notify([&]() { return m_value.fetch_add((T)1) + (T)1; }, false);
+        }
+
+        /**
+         * Atomically decrements the counter.
+         * It notifies one thread if the predicate returns true.
+         */
+        void decrement_and_notify_one() {
+            update_and_notify([&]() { return m_value.fetch_sub((T)1) - (T)1; }, false);
+        }
+
+        /**
+         * Atomically increments the counter.
+         * It notifies all threads if the predicate returns true.
+         */
+        void increment_and_notify_all() {
+            update_and_notify([&]() { return m_value.fetch_add((T)1) + (T)1; }, true);
+        }
+
+        /**
+         * Atomically decrements the counter.
+         * It notifies all threads if the predicate returns true.
+         * @param value value to subtract.
+         */
+        void decrement_and_notify_all(const T& value = (T)1) {
+            update_and_notify([&]() { return m_value.fetch_sub(value) - value; }, true);
+        }
+
+        /**
+         * Waits for the counter to get to a specific value, depending on the predicate.
+         */
+        void wait() {
+            while (!is_ready()) {
+                block(std::chrono::nanoseconds::max());
+            }
+        }
+
+        /**
+         * Waits for the counter to get to a specific value, depending on the predicate,
+         * while executing pending jobs of an executor; see counter::wait(E&).
+         * @param ex executor to execute pending jobs of; any type that provides execute_pending_job().
+         */
+        template <class E> void wait(E& ex) {
+            wait_internals::help_while_waiting(ex, [&]() { return is_ready(); }, [&](std::chrono::nanoseconds timeout) { block(timeout); });
+        }
+
+    private:
+        std::atomic<T> m_value;
+        P m_pred;
+
+        //the word threads block on; incremented on each notification to waiters
+        std::atomic<uint32_t> m_epoch{ 0 };
+
+        //number of waiting threads
+        std::atomic<uint32_t> m_waiter_count{ 0 };
+
+        //number of threads that are notifying
+        std::atomic<uint32_t> m_notifier_count{ 0 };
+
+        //checks if the predicate holds; if so, waits for the notifiers to release the counter,
+        //since the waiter may destroy it
+        bool is_ready() const {
+            if (!m_pred(m_value.load(std::memory_order_acquire))) {
+                return false;
+            }
+            while (m_notifier_count.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        //blocks until notified, unless the predicate holds after registering as a waiter;
+        //a notifier either sees the waiter, or the waiter sees the notifier's value
+        void block(std::chrono::nanoseconds timeout) {
+            const uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+            m_waiter_count.fetch_add(1);
+            if (!m_pred(m_value.load())) {
+                wait_on_address(m_epoch, epoch, timeout);
+            }
+            m_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        //updates the value; if the predicate holds, wakes up waiters, if there are any
+        template <class F> void update_and_notify(F&& update, bool all) {
+            m_notifier_count.fetch_add(1, std::memory_order_relaxed);
+            if (m_pred(update()) && m_waiter_count.load() != 0) {
+                m_epoch.fetch_add(1, std::memory_order_release);
+                if (all) {
+                    wake_by_address_all(m_epoch);
+                }
+                else {
+                    wake_by_address_one(m_epoch);
+                }
+            }
+            m_notifier_count.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_ATOMIC_COUNTER_HPP
@@ -0,0 +1,114 @@
+#ifndef EXECLIB_BARRIER_HPP
+#define EXECLIB_BARRIER_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <utility>
+#include "address_wait.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * The default completion function of barrier; does nothing.
+     */
+    struct barrier_no_completion {
+        /**
+         * Does nothing.
+         */
+        void operator ()() const {
+        }
+    };
+
+
+    /**
+     * A reusable barrier: a number of threads arrive at the barrier, then all of them continue together.
+     * 
+     * The completion function is invoked by the last arriving thread of each phase, before the others continue.
+     * Threads block on the address of the phase number (a futex on Linux); a bit of the phase number
+     * is set when there are waiting threads, and completing a phase does not make a system call unless it is set.
+     * 
+     * @param F type of the completion function.
+     */
+    template <class F = barrier_no_completion> class barrier {
+    public:
+        /**
+         * The constructor.
+         * @param count number of threads that arrive on each phase.
+         * @param completion completion function.
+         */
+        explicit barrier(uint32_t count, F&& completion = F()) :
+            m_expected_count(count),
+            m_remaining_count(count),
+            m_completion(std::move(completion))
+        {
+        }
+
+        barrier(const barrier&) = delete;
+        barrier& operator = (const barrier&) = delete;
+
+        /**
+         * Arrives at the barrier, then waits for the other threads to arrive.
+         */
+        void arrive_and_wait() {
+            const uint32_t phase = m_phase.load(std::memory_order_acquire) >> 1;
+            if (!arrive()) {
+                wait(phase);
+            }
+        }
+
+        /**
+         * Arrives at the barrier, and decrements the number of threads expected on the next phases.
+         */
+        void arrive_and_drop() {
+            m_expected_count.fetch_sub(1, std::memory_order_relaxed);
+            arrive();
+        }
+
+    private:
+        //number of threads expected on each phase
+        std::atomic<uint32_t> m_expected_count;
+
+        //number of threads yet to arrive on the current phase
+        std::atomic<uint32_t> m_remaining_count;
+
+        //the phase number, shifted left by one; the lowest bit is set when there are waiting threads;
+        //threads block on it
+        std::atomic<uint32_t> m_phase{ 0 };
+
+        F m_completion;
+
+        //arrives at the barrier; the last thread completes the phase; returns true if the phase was completed;
+        //the barrier is not accessed after the phase changes, since a waiter may destroy it
+        bool arrive() {
+            if (m_remaining_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return false;
+            }
+            m_completion();
+            m_remaining_count.store(m_expected_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            const uint32_t phase = m_phase.load(std::memory_order_relaxed) >> 1;
+            if (m_phase.exchange((phase + 1) << 1) & 1) {
+                wake_by_address_all(m_phase);
+            }
+            return true;
+        }
+
+        //sets the waiters bit, then waits for the given phase to complete
+        void wait(uint32_t phase) {
+            uint32_t word = m_phase.load(std::memory_order_acquire);
+            while ((word >> 1) == phase) {
+                if ((word & 1) || m_phase.compare_exchange_weak(word, word | 1)) {
+                    wait_on_address(m_phase, word | 1);
+                    word = m_phase.load(std::memory_order_acquire);
+                }
+            }
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_BARRIER_HPP
@@ -0,0 +1,95 @@
+#ifndef EXECLIB_COROUTINE_HPP
+#define EXECLIB_COROUTINE_HPP
+
+
+#include <optional>
+#include "executor.hpp"
+#include "counter.hpp"
+
+
+#ifdef EXECLIB_HAS_COROUTINES
+
+
+namespace execlib {
+
+
+    /**
+     * Awaiter of a counter, returned by co_await on a counter.
+     * The coroutine is suspended until the predicate of the counter holds, instead of blocking a worker thread;
+     * it is then resumed as a job of the executor it was suspended on, or, if it was not suspended
+     * on a worker thread, by the thread that notified the counter.
+     * No memory is allocated; the job that resumes the coroutine is embedded in the awaiter.
+     * @param T type of counter value.
+     * @param P type of counter predicate.
+     */
+    template <class T, class P> class counter_awaiter : private counter_waiter {
+    public:
+        /**
+         * The constructor.
+         * @param c counter to wait for.
+         */
+        counter_awaiter(counter<T, P>& c) : m_counter(c) {
+            resume = &resume_waiter;
+        }
+
+        /**
+         * Checks if the predicate of the counter holds.
+         * @return true if the predicate holds.
+         */
+        bool await_ready() const {
+            return m_counter.is_ready();
+        }
+
+        /**
+         * Suspends the coroutine until the counter is notified with the predicate holding.
+         * @param handle handle of the coroutine.
+         * @return false if the predicate holds, i.e. the coroutine is not suspended.
+         */
+        bool await_suspend(std::coroutine_handle<> handle) {
+            m_handle = handle;
+            m_executor = executor::get_current_executor();
+            return m_counter.add_waiter(this);
+        }
+
+        /**
+         * Invoked when the coroutine is resumed.
+         */
+        void await_resume() const noexcept {}
+
+    private:
+        counter<T, P>& m_counter;
+        std::coroutine_handle<> m_handle;
+        executor* m_executor = nullptr;
+        std::optional<executor::schedule_awaiter> m_schedule;
+
+        //resumes the coroutine as a job of the executor, or directly
+        static void resume_waiter(counter_waiter* waiter) {
+            counter_awaiter* awaiter = static_cast<counter_awaiter*>(waiter);
+            if (awaiter->m_executor) {
+                awaiter->m_schedule.emplace(awaiter->m_executor->schedule());
+                awaiter->m_schedule->await_suspend(awaiter->m_handle);
+            }
+            else {
+                awaiter->m_handle.resume();
+            }
+        }
+    };
+
+
+    /**
+     * Allows a coroutine to wait for a counter: co_await c.
+     * @param c counter to wait for.
+     * @return an awaiter.
+     */
+    template <class T, class P> counter_awaiter<T, P> operator co_await(counter<T, P>& c) {
+        return counter_awaiter<T, P>(c);
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_HAS_COROUTINES
+
+
+#endif //EXECLIB_COROUTINE_HPP
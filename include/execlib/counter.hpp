@@ -3,8 +3,10 @@
 
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include "wait_internals.hpp"
 
 
 namespace execlib {
@@ -42,15 +44,35 @@ namespace execlib {
 
         /**
          * Tests if the counter equals a specific value.
-         * @param value current value.
+         * @param current current value.
          * @return true if equals a value, false otherwise.
          */
-        bool operator ()(T value) const {
-            return value == this.value;
+        bool operator ()(T current) const {
+            return current == value;
         }
     };
 
 
+    /**
+     * Internal; a waiter that is resumed when the predicate of a counter holds, instead of blocking a thread.
+     * Used by the coroutine awaiter of counter.
+     */
+    struct counter_waiter {
+        /**
+         * Next waiter of the counter.
+         */
+        counter_waiter* next = nullptr;
+
+        /**
+         * Invoked when the predicate holds; the waiter may be destroyed by it.
+         */
+        void (*resume)(counter_waiter* waiter) = nullptr;
+    };
+
+
+    template <class T, class P> class counter_awaiter;
+
+
     /**
      * A synchronized counter class.
      * It can be used to implement waiting for tasks when the counter reaches a specific value.
@@ -146,10 +168,7 @@ namespace execlib {
          * It notifies one thread if the predicate returns true.
          */
         void increment_and_notify_one() {
-            const T new_value = m_value.fetch_add((T)1, std::memory_order_release) + (T)1;
-            if (m_pred(new_value)) {
-                m_cond.notify_one();
-            }
+            update_and_notify([&]() { return m_value.fetch_add((T)1, std::memory_order_release) + (T)1; }, false);
         }
 
         /**
@@ -157,10 +176,7 @@ namespace execlib {
          * It notifies one thread if the predicate returns true.
          */
         void decrement_and_notify_one() {
-            const T new_value = m_value.fetch_sub((T)1, std::memory_order_release) - (T)1;
-            if (m_pred(new_value)) {
-                m_cond.notify_one();
-            }
+            update_and_notify([&]() { return m_value.fetch_sub((T)1, std::memory_order_release) - (T)1; }, false);
         }
 
         /**
@@ -168,21 +184,15 @@ namespace execlib {
          * It notifies all threads if the predicate returns true.
          */
         void increment_and_notify_all() {
-            const T new_value = m_value.fetch_add((T)1, std::memory_order_release) + (T)1;
-            if (m_pred(new_value)) {
-                m_cond.notify_all();
-            }
+            update_and_notify([&]() { return m_value.fetch_add((T)1, std::memory_order_release) + (T)1; }, true);
         }
 
         /**
          * Atomically decrements the counter.
-         * It notifies all threads.
+         * It notifies all threads if the predicate returns true.
          */
         void decrement_and_notify_all() {
-            const T new_value = m_value.fetch_sub((T)1, std::memory_order_release) - (T)1;
-            if (m_pred(new_value)) {
-                m_cond.notify_all();
-            }
+            update_and_notify([&]() { return m_value.fetch_sub((T)1, std::memory_order_release) - (T)1; }, true);
         }
 
         /**
@@ -190,10 +200,29 @@ namespace execlib {
          * depending on the predicate.
          */
         void wait() {
-            while (!m_pred(m_value.load(std::memory_order_acquire))) {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [&]() { return m_pred(m_value.load(std::memory_order_acquire)); });
+        }
+
+        /**
+         * Waits for the counter to get to a specific value, depending on the predicate,
+         * while executing pending jobs of an executor.
+         * 
+         * When invoked from a job, the worker thread keeps executing the jobs of its queue,
+         * and stealing jobs from other queues, until the predicate holds; therefore fork-join
+         * algorithms do not deadlock, even on an executor with one thread, and they do not
+         * need to release the worker thread. When there are no pending jobs, the thread yields,
+         * then blocks for short periods, checking again for pending jobs.
+         * 
+         * @param ex executor to execute pending jobs of; any type that provides execute_pending_job().
+         */
+        template <class E> void wait(E& ex) {
+            wait_internals::help_while_waiting(ex, [&]() { return is_ready(); }, [&](std::chrono::microseconds timeout) {
                 std::unique_lock lock(m_mutex);
-                m_cond.wait(lock);
-            }
+                if (!m_pred(m_value.load(std::memory_order_acquire))) {
+                    m_cond.wait_for(lock, timeout);
+                }
+            });
         }
 
     private:
@@ -201,6 +230,61 @@ namespace execlib {
         P m_pred;
         std::mutex m_mutex;
         std::condition_variable m_cond;
+        counter_waiter* m_waiters = nullptr;
+
+        //updates the value under the lock; if the predicate holds, notifies the blocked threads, 
+        //then resumes the waiters taken from the counter; the counter is not accessed after the lock is released,
+        //since a thread that sees the predicate holding may destroy it
+        template <class F> void update_and_notify(F&& update, bool all) {
+            counter_waiter* waiters;
+            {
+                std::lock_guard lock(m_mutex);
+                if (!m_pred(update())) {
+                    return;
+                }
+                waiters = m_waiters;
+                if (all) {
+                    m_cond.notify_all();
+                    m_waiters = nullptr;
+                }
+                else {
+                    m_cond.notify_one();
+                    if (waiters) {
+                        m_waiters = waiters->next;
+                        waiters->next = nullptr;
+                    }
+                }
+            }
+
+            while (waiters) {
+                counter_waiter* next = waiters->next;
+                waiters->resume(waiters);
+                waiters = next;
+            }
+        }
+
+        //checks if the predicate holds; if so, the lock is acquired once,
+        //so as that a notifier that updated the value has released the counter
+        bool is_ready() {
+            if (!m_pred(m_value.load(std::memory_order_acquire))) {
+                return false;
+            }
+            std::lock_guard lock(m_mutex);
+            return true;
+        }
+
+        //adds a waiter, unless the predicate already holds; returns false if the predicate holds
+        bool add_waiter(counter_waiter* waiter) {
+            std::lock_guard lock(m_mutex);
+            if (m_pred(m_value.load(std::memory_order_acquire))) {
+                return false;
+            }
+            waiter->next = m_waiters;
+            m_waiters = waiter;
+            return true;
+        }
+
+        template <class U, class Q> friend class counter_awaiter;
     };
 
 
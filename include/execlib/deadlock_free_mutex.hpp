@@ -2,18 +2,62 @@
 #define EXECLIB_DEADLOCK_FREE_MUTEX_HPP
 
 
+#include <cstddef>
+#include <atomic>
 #include <mutex>
+#include <vector>
+#include <iterator>
+#include <type_traits>
 
 
 namespace execlib {
 
 
+    /**
+     * Contention statistics of a deadlock_free_mutex.
+     * Recursive locks by the thread that owns the mutex are not counted.
+     */
+    struct deadlock_free_mutex_stats {
+        /**
+         * Number of times the mutex was acquired.
+         */
+        size_t lock_count = 0;
+
+        /**
+         * Number of acquisitions where the mutex was locked by another thread.
+         */
+        size_t contended_lock_count = 0;
+
+        /**
+         * Number of contended acquisitions that succeeded while spinning,
+         * without unlocking other mutexes or blocking.
+         */
+        size_t spin_lock_count = 0;
+
+        /**
+         * Number of times the mutexes above this one were unlocked and relocked.
+         */
+        size_t relock_count = 0;
+
+        /**
+         * Number of failed try_lock calls.
+         */
+        size_t failed_try_lock_count = 0;
+    };
+
+
     /**
      * A deadlock-free mutex.
      * 
      * It achieves deadlock avoidance by unlocking and then relocking all mutexes
      * locked by this thread and that are above this, in memory order.
      * 
+     * It is recursive; the mutexes locked by a thread are kept in a thread-local array,
+     * sorted by address, along with the number of times each one is locked.
+     * 
+     * When the mutex is locked by another thread, the thread spins for a while, with an adaptive
+     * spin count per mutex, before unlocking the mutexes above it; consecutive failed attempts of try_lock
+     * back off exponentially before unlocking and relocking them again.
      */
     class deadlock_free_mutex {
     public:
@@ -32,12 +76,165 @@ namespace execlib {
          */
         void unlock();
 
+        /**
+         * Returns the contention statistics of the mutex.
+         * They are updated without synchronization with this call, therefore they are approximate
+         * if the mutex is in use.
+         * @return the statistics.
+         */
+        deadlock_free_mutex_stats stats() const;
+
+        /**
+         * Locks an array of mutexes, in address order, in one pass; see execlib::lock_all.
+         * The array is sorted; duplicates are locked recursively.
+         * @param first start of the array.
+         * @param last end of the array.
+         */
+        static void lock_all(deadlock_free_mutex** first, deadlock_free_mutex** last);
+
+    private:
+        //counter updated only by the owner of the mutex; read by any thread
+        class stats_counter {
+        public:
+            void add() { m_value.store(m_value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+            size_t get() const { return m_value.load(std::memory_order_relaxed); }
+        private:
+            std::atomic<size_t> m_value{ 0 };
+        };
+
+        //the mutex; recursion is counted by the thread's locked mutex table
+        std::mutex m_mutex;
+
+        //average number of iterations successful spins take; it decays when spins fail
+        std::atomic<unsigned> m_spin_estimate{ 0 };
+
+        //statistics; the counters are updated while the mutex is locked, 
+        //the atomic ones when the mutex may not be locked
+        stats_counter m_lock_count;
+        stats_counter m_contended_lock_count;
+        stats_counter m_spin_lock_count;
+        std::atomic<size_t> m_relock_count{ 0 };
+        std::atomic<size_t> m_failed_try_lock_count{ 0 };
+
+        //number of consecutive try_lock calls that failed to lock this mutex after unlocking the mutexes above it;
+        //the back-off before relocking grows with it
+        std::atomic<unsigned> m_failed_relock_count{ 0 };
+
+        //spins trying to lock the mutex; returns true if locked
+        bool spin_lock();
+
+        //resets the failed relock count, when the mutex is acquired; the count is not written if it is 0,
+        //so as that uncontended acquisitions do not write to it
+        void reset_failed_relock_count() {
+            if (m_failed_relock_count.load(std::memory_order_relaxed) != 0) {
+                m_failed_relock_count.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+
+    /**
+     * Locks the given mutexes.
+     * 
+     * The mutexes are locked in address order, in one pass, and they are added
+     * to the thread's locked mutex table at once; if one of them is locked by another thread,
+     * the mutexes above it already locked by this thread are unlocked once and relocked
+     * along with the rest, instead of once per mutex.
+     * A mutex that appears more than once is locked recursively, once per appearance.
+     * 
+     * @param mutex first mutex.
+     * @param mutexes rest of the mutexes.
+     */
+    template <class... M> void lock_all(deadlock_free_mutex& mutex, M&... mutexes) {
+        deadlock_free_mutex* array[] = { &mutex, &mutexes... };
+        deadlock_free_mutex::lock_all(array, array + 1 + sizeof...(M));
+    }
+
+
+    /**
+     * Locks a range of mutexes; see lock_all(deadlock_free_mutex&, M&...).
+     * @param first start of the range; its elements are mutexes or pointers to mutexes.
+     * @param last end of the range.
+     */
+    template <class It, class = typename std::iterator_traits<It>::iterator_category> void lock_all(It first, It last) {
+        std::vector<deadlock_free_mutex*> array;
+        for (; first != last; ++first) {
+            if constexpr (std::is_pointer_v<typename std::iterator_traits<It>::value_type>) {
+                array.push_back(*first);
+            }
+            else {
+                array.push_back(&*first);
+            }
+        }
+        deadlock_free_mutex::lock_all(array.data(), array.data() + array.size());
+    }
+
+
+    /**
+     * Unlocks the given mutexes.
+     * @param mutexes the mutexes.
+     */
+    template <class... M> void unlock_all(M&... mutexes) {
+        (mutexes.unlock(), ...);
+    }
+
+
+    /**
+     * Unlocks a range of mutexes.
+     * @param first start of the range; its elements are mutexes or pointers to mutexes.
+     * @param last end of the range.
+     */
+    template <class It, class = typename std::iterator_traits<It>::iterator_category> void unlock_all(It first, It last) {
+        for (; first != last; ++first) {
+            if constexpr (std::is_pointer_v<typename std::iterator_traits<It>::value_type>) {
+                (*first)->unlock();
+            }
+            else {
+                first->unlock();
+            }
+        }
+    }
+
+
+    /**
+     * Scoped guard that locks mutexes with lock_all, and unlocks them on destruction:
+     * lock_all_guard guard(mutexA, mutexB).
+     * @param N number of mutexes.
+     */
+    template <size_t N> class lock_all_guard {
+    public:
+        /**
+         * Locks the mutexes.
+         * @param mutexes the mutexes.
+         */
+        template <class... M> explicit lock_all_guard(M&... mutexes) : m_mutexes{ &mutexes... } {
+            deadlock_free_mutex* array[N] = { &mutexes... };
+            deadlock_free_mutex::lock_all(array, array + N);
+        }
+
+        lock_all_guard(const lock_all_guard&) = delete;
+        lock_all_guard& operator = (const lock_all_guard&) = delete;
+
+        /**
+         * Unlocks the mutexes.
+         */
+        ~lock_all_guard() {
+            for (deadlock_free_mutex* mutex : m_mutexes) {
+                mutex->unlock();
+            }
+        }
+
     private:
-        //the mutex
-        std::recursive_mutex m_mutex;
+        deadlock_free_mutex* m_mutexes[N];
     };
 
 
+    /**
+     * Deduction guide for lock_all_guard.
+     */
+    template <class... M> lock_all_guard(M&...) -> lock_all_guard<sizeof...(M)>;
+
+
 } //namespace execlib
 
 
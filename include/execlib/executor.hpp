@@ -2,16 +2,107 @@
 #define EXECLIB_JOB_EXECUTOR_HPP
 
 
+#include <cstdint>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#ifdef EXECLIB_TRACE
+#include <iosfwd>
+#endif
+#include "executor_options.hpp"
+#include "executor_stats.hpp"
 #include "executor_internals.hpp"
 
 
 namespace execlib {
 
 
+    /**
+     * Priority of a job.
+     * 
+     * Each queue has a lane per priority; worker threads execute the jobs of higher priority lanes first.
+     * Background jobs are stolen only when no queue has jobs of higher priority.
+     */
+    enum class job_priority {
+        /**
+         * For latency-critical jobs.
+         */
+        high,
+
+        /**
+         * The default priority.
+         */
+        normal,
+
+        /**
+         * For batch jobs that must not delay other jobs.
+         */
+        background
+    };
+
+
+    /**
+     * Mode of executor::shutdown.
+     */
+    enum class shutdown_mode {
+        /**
+         * The pending jobs, and the jobs they submit, are executed before the worker threads stop.
+         */
+        drain,
+
+        /**
+         * The pending jobs are destroyed without being executed, as if they were cancelled;
+         * running jobs complete.
+         */
+        discard
+    };
+
+
+    /**
+     * Tag type for selecting the execute overload that returns a future.
+     */
+    struct use_future_t {
+    };
+
+
+    /**
+     * Tag for selecting the execute overload that returns a future.
+     */
+    inline constexpr use_future_t use_future{};
+
+
+    /**
+     * Handle of a timer created by executor::execute_at, executor::execute_after, or executor::execute_every.
+     * It allows the timer to be cancelled; it remains safe to use after the timer expires or is cancelled.
+     */
+    class timer_handle {
+    public:
+        /**
+         * Creates an empty handle.
+         */
+        timer_handle() = default;
+
+        /**
+         * Checks if the handle was returned by a timer function.
+         * @return true if the handle refers to a timer, false if it is empty.
+         */
+        bool valid() const { return m_timer != nullptr; }
+
+    private:
+        void* m_timer = nullptr;
+        uint64_t m_generation = 0;
+
+        timer_handle(void* timer, uint64_t generation) : m_timer(timer), m_generation(generation) {}
+
+        friend class executor;
+    };
+
+
     /**
      * Contains the mechanism for executing jobs in different threads.
      * It uses job stealing in order to avoid thread starving.
@@ -25,12 +116,49 @@ namespace execlib {
          */
         executor(size_t thread_count = std::thread::hardware_concurrency());
 
+        /**
+         * The constructor from options.
+         * @param options executor options.
+         * @exception std::invalid_argument thrown if options.thread_count is 0.
+         */
+        executor(const executor_options& options);
+
         /**
          * Signals all threads to stop execution, then waits for them to stop.
-         * Remaining jobs are not executed.
+         * Remaining jobs are not executed; they are destroyed, as with shutdown(shutdown_mode::discard).
          */
         ~executor();
 
+        /**
+         * Stops the worker threads and waits for them to stop.
+         * 
+         * With shutdown_mode::drain, the worker threads first execute the pending jobs, in parallel,
+         * until the executor is idle, as in wait_idle(); with shutdown_mode::discard, the running jobs complete,
+         * and the pending jobs are destroyed without being executed, and their memory is returned to the pools. 
+         * Embedded jobs, like the ones that resume coroutines, are not destroyed; the nodes of a task graph
+         * are cancelled, along with the nodes that depend on them, so as that the graph's run completes. Timers do not fire afterwards.
+         * 
+         * Jobs put in the executor after shutdown are not executed; they are destroyed by the destructor.
+         * 
+         * @param mode what to do with the pending jobs.
+         * @exception std::logic_error thrown if this is called from a worker thread of this executor.
+         */
+        void shutdown(shutdown_mode mode = shutdown_mode::drain);
+
+        /**
+         * Waits until the executor is idle: all the jobs put in its queues, including the jobs 
+         * submitted by other jobs, are executed, and no job is running. Pending timers are not waited for.
+         * After shutdown, it returns immediately.
+         * 
+         * The calling thread yields, then sleeps briefly, between checks; checking is done by comparing 
+         * the counts of jobs put and executed, which are kept per queue and per worker thread,
+         * without slowing down the execution of jobs.
+         * 
+         * @exception std::logic_error thrown if this is called from a worker thread of this executor,
+         *  whose job would never end.
+         */
+        void wait_idle();
+
         /**
          * Returns number of threads.
          * @return number of threads.
@@ -39,35 +167,213 @@ namespace execlib {
 
         /**
          * Executes the given job.
-         * The target thread is chosen in a round-robin fashion.
-         * Memory for the job is allocated in the context of the target thread.
+         * If invoked from a worker thread of this executor, and the nested submission policy is local,
+         * then the job is put in the current worker thread's queue; other threads get it only by stealing;
+         * the job's memory is allocated from the queue's pool, without locking.
+         * 
+         * Otherwise, the calling thread is a producer: it allocates the job's memory from a pool of its own,
+         * without locking, and puts the job in the inbox of the next queue of its own round-robin cycle,
+         * locking only that queue, for as long as it takes to append the job. The cycle contains
+         * the queues of the numa node the producer runs on, when it submits its first job; producers start
+         * from different queues, so as that they rarely compete for the same queue.
+         * @param func function to execute.
+         * @param priority priority of the job.
          */
-        template <class F> void execute(F&& func) {
-            using job_type = job_impl<F>;
+        template <class F> void execute(F&& func, job_priority priority = job_priority::normal) {
+            put_new_job<job_impl<std::decay_t<F>>>(priority, std::forward<F>(func));
+        }
 
-            //next queue index, in round robin fashion
-            const size_t queue_index = m_next_queue_index.fetch_add(1, std::memory_order_release) % m_queues.size();
+        /**
+         * Executes the given job and returns a future for its result.
+         * The job is scheduled as in execute(func).
+         * The shared state of the future is stored in the job's memory, allocated as in execute(func).
+         * @param func function to execute; its result is stored in the future.
+         * @param priority priority of the job; continuations have normal priority.
+         * @return a future for the function's result.
+         */
+        template <class F> auto execute(use_future_t, F&& func, job_priority priority = job_priority::normal) {
+            using job_type = future_job_impl<std::decay_t<F>>;
+            job_type* j = put_new_job<job_type>(priority, std::forward<F>(func), this);
+            return future<typename job_type::result_type>(j);
+        }
+
+        /**
+         * Executes the jobs of the given range.
+         * The jobs are split evenly across queues; each queue's mutex is locked once,
+         * all its jobs are allocated from its memory pool in one pass,
+         * and its thread is notified once. No more queues than jobs are used.
+         * @param first iterator to the first job; jobs are copied from the range,
+         *  unless a move iterator is used.
+         * @param last iterator to the end of the range.
+         * @param priority priority of the jobs.
+         */
+        template <class It> void execute_bulk(It first, It last, job_priority priority = job_priority::normal) {
+            using job_function_type = typename std::iterator_traits<It>::value_type;
+            const size_t count = (size_t)std::distance(first, last);
+            put_jobs<job_function_type>(count, priority, [&](size_t) { return job_function_type(*first++); });
+        }
 
-            //the queue to put the job to
-            queue* q = m_queues[queue_index];
+        /**
+         * Executes the given function the given number of times, with the indexes 0 to count - 1.
+         * The jobs are split evenly across queues, as in execute_bulk.
+         * @param count number of jobs.
+         * @param func function to execute; it is copied in every job;
+         *  it is invoked as func(index).
+         * @param priority priority of the jobs.
+         */
+        template <class F> void execute_n(size_t count, F&& func, job_priority priority = job_priority::normal) {
+            using job_function_type = indexed_function<std::decay_t<F>>;
+            put_jobs<job_function_type>(count, priority, [&](size_t index) { return job_function_type{ func, index }; });
+        }
 
-            //allocate/init job/put job in queue, synchronized on queue
-            {
-                std::lock_guard lock_queue(get_mutex(q));
+        /**
+         * Executes the given function at the given time point.
+         * 
+         * Timers are kept in a hierarchical timing wheel, with a resolution of one millisecond;
+         * insertion and cancellation are O(1). There is no timer thread: an idle worker thread
+         * fires the expired timers and parks until the next timer, and busy worker threads 
+         * fire expired timers between jobs. Functions of expired timers are executed as jobs; 
+         * they never execute before the time point.
+         * 
+         * @param time_point time point to execute the function at.
+         * @param func function to execute.
+         * @param priority priority of the job.
+         * @return handle of the timer.
+         */
+        template <class F> timer_handle execute_at(std::chrono::steady_clock::time_point time_point, F&& func, job_priority priority = job_priority::normal) {
+            return add_timer(new timer_task_impl<std::decay_t<F>, false>(std::forward<F>(func), priority), time_point, {});
+        }
 
-                //allocate memory for job; each queue has its own memory pool
-                void* mem = alloc_memory_for_job(q, sizeof(job_type));
+        /**
+         * Executes the given function after the given delay.
+         * Timers are fired as in execute_at.
+         * @param delay delay.
+         * @param func function to execute.
+         * @param priority priority of the job.
+         * @return handle of the timer.
+         */
+        template <class Rep, class Period, class F> timer_handle execute_after(const std::chrono::duration<Rep, Period>& delay, F&& func, job_priority priority = job_priority::normal) {
+            return execute_at(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay), std::forward<F>(func), priority);
+        }
 
-                //init job
-                job* j = new (mem) job_type(reinterpret_cast<queue_base*>(q), std::forward<F>(func));
+        /**
+         * Executes the given function periodically, starting after one period, until the timer is cancelled.
+         * Timers are fired as in execute_at; the function is copied for each execution.
+         * Periods missed because no thread could fire the timer are skipped.
+         * @param period period; it is rounded up to the timer resolution.
+         * @param func function to execute.
+         * @param priority priority of the jobs.
+         * @return handle of the timer.
+         */
+        template <class Rep, class Period, class F> timer_handle execute_every(const std::chrono::duration<Rep, Period>& period, F&& func, job_priority priority = job_priority::normal) {
+            const auto p = std::max(std::chrono::duration_cast<std::chrono::steady_clock::duration>(period), std::chrono::steady_clock::duration(1));
+            return add_timer(new timer_task_impl<std::decay_t<F>, true>(std::forward<F>(func), priority), std::chrono::steady_clock::now() + p, p);
+        }
 
-                //put the job in the queue
-                put_job(q, j);
+#ifdef EXECLIB_HAS_COROUTINES
+        /**
+         * Awaiter returned by schedule().
+         * The job that resumes the coroutine is embedded in the awaiter, which is stored in the coroutine frame;
+         * therefore scheduling a coroutine does not allocate memory.
+         */
+        class schedule_awaiter {
+        public:
+            /**
+             * The constructor.
+             * @param ex executor to resume the coroutine on.
+             * @param priority priority of the job that resumes the coroutine.
+             */
+            schedule_awaiter(executor* ex, job_priority priority) : m_executor(ex), m_priority(priority) {}
+
+            /**
+             * The coroutine is always suspended.
+             * @return false.
+             */
+            bool await_ready() const noexcept { return false; }
+
+            /**
+             * Puts a job that resumes the coroutine in a queue of the executor.
+             * @param handle handle of the coroutine.
+             */
+            void await_suspend(std::coroutine_handle<> handle) {
+                m_job.m_handle = handle;
+                m_executor->schedule_job(&m_job, m_priority);
             }
 
-            //notify the queue listener
-            notify_listener(q);
+            /**
+             * Invoked when the coroutine is resumed by a worker thread.
+             */
+            void await_resume() const noexcept {}
+
+        private:
+            executor* m_executor;
+            job_priority m_priority;
+            coroutine_job m_job;
+        };
+
+        /**
+         * Returns an awaiter that suspends the current coroutine, then resumes it as a job of this executor:
+         * co_await ex.schedule().
+         * If invoked from a worker thread of this executor, the job is put in the current worker thread's queue,
+         * otherwise in the next queue, in round-robin fashion.
+         * @param priority priority of the job that resumes the coroutine.
+         * @return an awaiter.
+         */
+        schedule_awaiter schedule(job_priority priority = job_priority::normal) {
+            return schedule_awaiter(this, priority);
         }
+#endif
+
+        /**
+         * Cancels a timer.
+         * @param timer handle of the timer.
+         * @return true if the timer was cancelled, false if it already expired, 
+         *  or it was already cancelled, or the handle is empty. 
+         *  A periodic timer is stopped, but an execution already scheduled still takes place.
+         */
+        bool cancel_timer(const timer_handle& timer);
+
+        /**
+         * Executes one pending job of this executor in the current thread, if there is one.
+         * 
+         * On a worker thread of this executor, the job is taken from the thread's queue,
+         * or stolen from other queues; on any other thread, it is stolen from the queues of this executor.
+         * 
+         * It allows threads that wait for jobs to complete to help with executing jobs,
+         * instead of blocking.
+         * 
+         * @return true if a job was executed, false if no pending job was found.
+         */
+        bool execute_pending_job();
+
+        /**
+         * Returns a snapshot of the statistics of the worker threads and queues.
+         * 
+         * Each worker thread keeps its own counters, in its own cache line, written only by itself;
+         * the snapshot aggregates them. Replacement threads created by release_current_worker_thread
+         * are included, which allows detecting oversubscription; terminated ones are not.
+         * 
+         * @return a snapshot of the statistics.
+         */
+        executor_stats stats() const;
+
+#ifdef EXECLIB_TRACE
+        /**
+         * Writes the recorded trace events in Chrome's trace event format (JSON),
+         * which is loaded by chrome://tracing and by Perfetto.
+         * 
+         * Tracing is enabled by defining EXECLIB_TRACE, for the library and for the code that uses it.
+         * Each worker thread, and each producer thread, records the jobs it puts in queues, the jobs it steals,
+         * and the start and finish of the jobs it executes, in a ring buffer of its own,
+         * without locking; the newest EXECLIB_TRACE_EVENT_COUNT events of each thread are kept.
+         * Jobs are identified by their address; flow arrows link the enqueueing of a job to its start.
+         * 
+         * It can be invoked while jobs are executed; the buffers are not cleared.
+         * 
+         * @param stream stream to write the trace to.
+         */
+        void write_trace(std::ostream& stream) const;
+#endif
 
         /**
          * Removes the current worker thread from the executor's active threads
@@ -81,9 +387,28 @@ namespace execlib {
          * for a long time: it allows the executor to continue executing jobs
          * on all queues, despite this thread blocking the worker thread.
          * 
+         * The replacement is an idle released thread, or a new thread, up to
+         * executor_options::release.max_thread_count. When the job ends, the released thread
+         * waits for a queue to take over, and terminates after the idle timeout.
+         * 
+         * @return true if the thread was released, false if the thread limit is reached or
+         *  the thread is already released; then the thread keeps its queue.
+         * @exception std::logic_error thrown if this is called outside of a worker thread.
+         */
+        static bool release_current_worker_thread();
+
+        /**
+         * Makes the current released worker thread the owner of the queue it released, again;
+         * it is invoked when the long-running part of a job is over.
+         * 
+         * The thread that owns the queue hands it over after its current job, then it becomes
+         * an idle released thread. This thread waits until then.
+         * 
+         * @return true if the queue was acquired, false if the thread is not released,
+         *  or if the executor is stopped.
          * @exception std::logic_error thrown if this is called outside of a worker thread.
          */
-        static void release_current_worker_thread();
+        static bool reacquire_current_worker_thread();
 
         /**
          * Returns the current executor.
@@ -103,39 +428,295 @@ namespace execlib {
         //worker thread defined in implementation file
         class worker_thread;
 
+        //state of a thread that puts jobs in the executor without owning a queue; defined in implementation file
+        class producer;
+
+        //timers defined in implementation file
+        class timer_queue;
+
+#ifdef EXECLIB_TRACE
+        //trace buffers defined in implementation file
+        class trace_recorder;
+#endif
+
+        //task of a timer; it creates a job when the timer expires
+        class timer_task {
+        public:
+            //destructor is virtual due to polymorphism
+            virtual ~timer_task() {}
+
+            //executes a job for the task
+            virtual void schedule(executor* ex) = 0;
+        };
+
+        //timer task implementation; a periodic task copies its function for each job,
+        //a one-shot task moves its function to the job
+        template <class F, bool Periodic> class timer_task_impl : public timer_task {
+        public:
+            //constructor
+            template <class G> timer_task_impl(G&& f, job_priority priority) 
+                : m_function(std::forward<G>(f)), m_priority(priority) 
+            {
+            }
+
+            //executes a job for the task
+            void schedule(executor* ex) override {
+                if constexpr (Periodic) {
+                    ex->execute(m_function, m_priority);
+                }
+                else {
+                    ex->execute(std::move(m_function), m_priority);
+                }
+            }
+
+        private:
+            F m_function;
+            const job_priority m_priority;
+        };
+
+        //options
+        const executor_options m_options;
+
+        //unique id of the executor; producers of the current thread are cached by executor id,
+        //since an executor may be created at the address of a destroyed one
+        const uint64_t m_id;
+
         //queues are used in a round-robin fashion
         std::atomic<size_t> m_next_queue_index{};
 
+        //number of worker threads waiting for jobs
+        std::atomic<size_t> m_idle_worker_thread_count{};
+
         //queues
         std::vector<queue*> m_queues;
 
         //worker thread mutex
-        std::mutex m_worker_thread_mutex;
+        mutable std::mutex m_worker_thread_mutex;
 
         //all worker threads
         std::vector<worker_thread*> m_worker_threads;
 
-        //released worker threads
+        //released worker threads that wait for a queue
         std::vector<worker_thread*> m_released_worker_threads;
 
+        //worker threads that terminated after the idle timeout; they are joined and deleted later
+        std::vector<worker_thread*> m_exited_worker_threads;
+
+        //number of worker threads that terminated after the idle timeout
+        size_t m_reaped_worker_thread_count = 0;
+
+        //number of jobs executed by worker threads that terminated
+        uint64_t m_exited_executed_job_count = 0;
+
+        //set by shutdown; no worker threads are created afterwards
+        bool m_stopped = false;
+
+        //number of jobs executed by threads that do not own a queue, or discarded
+        std::atomic<uint64_t> m_other_executed_job_count{ 0 };
+
+        //timers
+        timer_queue* m_timers;
+
+        //producer mutex
+        std::mutex m_producer_mutex;
+
+        //producers, one per thread that put jobs in the executor without owning a queue; 
+        //they are deleted with the executor, since their pools may contain jobs
+        std::vector<producer*> m_producers;
+
+#ifdef EXECLIB_TRACE
+        //trace buffers of the worker threads and of the producers
+        trace_recorder* m_trace_recorder;
+#endif
+
+        //passes an exception thrown by a job that does not store it to the exception handler
+        void handle_exception(std::exception_ptr e);
+
+        //checks if all the jobs put in queues are executed
+        bool is_idle() const;
+
+        //stops and joins all worker threads
+        void stop_worker_threads();
+
+        //destroys the jobs left in the queues
+        void discard_pending_jobs();
+
+        //adds a timer; a zero period is for one-shot timers
+        timer_handle add_timer(timer_task* task, std::chrono::steady_clock::time_point time_point, std::chrono::steady_clock::duration period);
+
         //get mutex of queue
         static std::mutex& get_mutex(queue* q);
 
-        //allocate memory from queue
-        static void* alloc_memory_for_job(queue* q, size_t size);
+        //scope for allocating jobs from a queue and putting jobs to it:
+        //if the current thread owns the queue, the jobs are allocated from the queue's local pool, without locking;
+        //otherwise, the queue is locked and the jobs are allocated from the queue's shared pool
+        class queue_scope {
+        public:
+            //constructor
+            queue_scope(queue* q) : m_pool(get_local_pool(q)) {
+                if (m_pool != current_local_pool) {
+                    m_pool = get_shared_pool(q);
+                    m_mutex = &get_mutex(q);
+                    m_mutex->lock();
+                }
+            }
+
+            //destructor
+            ~queue_scope() {
+                if (m_mutex) {
+                    m_mutex->unlock();
+                }
+            }
+
+            //returns the pool to allocate jobs from
+            job_pool* pool() const { return m_pool; }
+
+            queue_scope(const queue_scope&) = delete;
+            queue_scope& operator = (const queue_scope&) = delete;
+
+        private:
+            job_pool* m_pool;
+            std::mutex* m_mutex = nullptr;
+        };
+
+        //allocates a job in the given memory pool
+        template <class J, class... A> J* new_job(job_pool* pool, A&&... args) {
+            //allocate memory for job; each queue has its own memory pools
+            void* mem = alloc_memory_for_job(pool, sizeof(J));
+
+            //init job
+            return new (mem) J(pool, std::forward<A>(args)...);
+        }
+
+        //allocates a job and puts it in the lane of the given priority of the current worker thread's queue,
+        //for nested submissions, else of the current producer's next queue, then notifies the queue's listener
+        template <class J, class... A> J* put_new_job(job_priority priority, A&&... args) {
+            //the current worker thread's queue: allocate/init job/put job in queue, lock-free
+            if (queue* q = get_local_queue()) {
+                J* j;
+                {
+                    queue_scope scope(q);
+                    j = new_job<J>(scope.pool(), std::forward<A>(args)...);
+                    put_job(q, j, priority);
+                }
+                notify_listener(q);
+                return j;
+            }
+
+            //other threads: allocate/init job lock-free, from the producer's pool, then put the job in a queue
+            producer* p = get_current_producer();
+            J* j = new_job<J>(get_producer_pool(p), std::forward<A>(args)...);
+            put_producer_job(p, j, priority);
+            return j;
+        }
+
+        //allocates a job that is not put in a queue yet, lock-free, from the current worker thread's queue,
+        //or from the producer's pool
+        template <class J, class... A> J* allocate_job(A&&... args) {
+            if (queue* q = get_local_queue()) {
+                queue_scope scope(q);
+                return new_job<J>(scope.pool(), std::forward<A>(args)...);
+            }
+            return new_job<J>(get_producer_pool(get_current_producer()), std::forward<A>(args)...);
+        }
+
+        //allocates a future job that is the continuation of the given future job;
+        //the continuation is put in a queue when the given job completes
+        template <class F, class P> auto new_continuation_job(P* prev, F&& func) {
+            using job_type = future_job_impl<std::decay_t<F>>;
+
+            job_type* j = allocate_job<job_type>(std::forward<F>(func), this);
+
+            //make the future before setting the continuation, because the continuation might complete immediately
+            future<typename job_type::result_type> result(j);
+            prev->set_continuation(j);
+            return result;
+        }
+
+        //puts an allocated job in the current worker thread's queue, 
+        //or in the current producer's next queue, if the current thread is not a worker thread of this executor
+        void schedule_job(job* j, job_priority priority = job_priority::normal);
+
+        //returns the producer of the current thread, creating it on first use
+        producer* get_current_producer();
+
+        //returns the pool of a producer; it is allocated from by the producer's thread only
+        static job_pool* get_producer_pool(producer* p);
+
+        //puts a job in the lane of the given priority of the producer's next queue, 
+        //then notifies the queue's listener
+        void put_producer_job(producer* p, job* j, job_priority priority);
+
+        //splits the given number of jobs across queues; for each queue,
+        //it allocates and puts all its jobs while the queue is locked, then notifies the queue once;
+        //the jobs functions are created by make_function(index)
+        template <class F, class M> void put_jobs(size_t count, job_priority priority, M&& make_function) {
+            using job_type = job_impl<F>;
+
+            if (count == 0) {
+                return;
+            }
 
-        //put job in queue
-        static void put_job(queue* q, job* j);
+            //the number of queues to use; one fetch_add for all jobs
+            const size_t queue_count = std::min(count, m_queues.size());
+            const size_t first_queue_index = m_next_queue_index.fetch_add(queue_count, std::memory_order_release);
 
-        //notifies the queue listener that a new job is available
-        static void notify_listener(queue* q);
+            for (size_t i = 0, index = 0; i < queue_count; ++i) {
+                queue* q = m_queues[(first_queue_index + i) % m_queues.size()];
+
+                //number of jobs for this queue
+                const size_t job_count = count / queue_count + (i < count % queue_count ? 1 : 0);
+
+                //allocate/init jobs/put jobs in queue, locked once
+                {
+                    queue_scope scope(q);
+                    for (const size_t end = index + job_count; index < end; ++index) {
+                        put_job(q, new_job<job_type>(scope.pool(), make_function(index)), priority);
+                    }
+                }
+
+                //notify the queue listener once
+                notify_listener(q);
+            }
+        }
+
+        //returns the local pool of a queue
+        static job_pool* get_local_pool(queue* q);
+
+        //returns the shared pool of a queue
+        static job_pool* get_shared_pool(queue* q);
+
+        //allocate memory from pool
+        static void* alloc_memory_for_job(job_pool* pool, size_t size);
+
+        //put job in the lane of the given priority of a queue
+        void put_job(queue* q, job* j, job_priority priority);
+
+        //returns the current worker thread's queue, if the current thread is a worker thread 
+        //of this executor and the nested submission policy is local, otherwise null
+        queue* get_local_queue() const;
+
+        //notifies the queue listener that a new job is available;
+        //for the current worker thread's queue, it wakes up an idle worker thread to steal the job
+        void notify_listener(queue* q);
+
+        //wakes up an idle worker thread, other than the owner of the given queue
+        void notify_idle_worker_thread(queue* q);
 
         friend class _executor;
         friend class worker_thread;
+        friend class executor_internals;
+        friend class task_group;
+        friend class task_graph;
+        friend class strand;
+        template <class T> friend class future;
     };
 
 
 } //namespace execlib
 
 
+#include "future.hpp"
+
+
 #endif //EXECLIB_JOB_EXECUTOR_HPP
@@ -2,7 +2,20 @@
 #define EXECLIB_EXECUTOR_INTERNALS_HPP
 
 
+#include <cstddef>
+#include <cstdint>
 #include <utility>
+#include <atomic>
+#include <optional>
+#include <exception>
+#include <future>
+#include <chrono>
+#include <type_traits>
+#include "address_wait.hpp"
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define EXECLIB_HAS_COROUTINES 1
+#endif
 
 
 namespace execlib {
@@ -11,52 +24,349 @@ namespace execlib {
     class executor;
 
 
+    template <class T> class future;
+
+
+    class task_group;
+
+
+    class task_graph;
+
+
+    class strand;
+
+
     //executor internals
     class executor_internals {
     private:
         //queue base
         struct queue_base;
 
+        //memory pool for jobs
+        struct job_pool;
+
+        //the pool of the queue owned by the current thread; null for threads that do not own a queue;
+        //jobs of this pool are deallocated directly, other jobs are returned via their pool's remote free list
+        static thread_local job_pool* current_local_pool;
+
+        //operations of a job, performed by the job's thunk
+        enum class job_operation {
+            //invokes the job, then releases it
+            execute,
+
+            //releases the job without invoking it; for jobs that are cancelled or discarded before they start
+            cancel,
+
+            //stores the exception thrown while executing the job, then releases the job;
+            //the thunk returns false if the job does not store exceptions
+            fail,
+
+            //destroys the job and deallocates its memory
+            destroy
+        };
+
         //interface for jobs.
+        //There are no virtual functions: each job type passes a thunk, a static function that performs
+        //the operations on jobs of that type, knowing the type at compile time; executing a job is one indirect call, 
+        //which invokes the job, then destroys it, skipping trivial destructors, and deallocates its memory, 
+        //whose size is the size of the type, therefore it is not stored.
         class job {
         public:
+            //thunk of a job type
+            using thunk = bool (*)(job* j, job_operation op, std::exception_ptr* e);
+
             //constructor
-            job(size_t size, queue_base* q) : m_size(size), m_queue(q) {}
+            job(thunk t, job_pool* pool) : m_thunk(t), m_pool(pool) {}
 
-            //destructor is virtual due to polymorphism
-            virtual ~job() {}
+            //performs an operation on the job
+            bool perform(job_operation op, std::exception_ptr* e = nullptr) {
+                return m_thunk(this, op, e);
+            }
 
-            //executes the job
-            virtual void invoke() = 0;
+            //checks if the job is embedded in another object, instead of being allocated from a pool;
+            //embedded jobs are not released after execution, since they might no longer exist
+            bool is_embedded() const {
+                return m_pool == nullptr;
+            }
 
-            //deletes this job.
-            void delete_this();
+        protected:
+            //destroys a job of the given type and deallocates its memory; the destructor is not invoked if it is trivial
+            template <class J> static void delete_job(J* j) {
+                job_pool* const pool = j->m_pool;
+                if constexpr (!std::is_trivially_destructible_v<J>) {
+                    j->~J();
+                }
+                deallocate(pool, j, sizeof(J));
+            }
 
         private:
-            const size_t m_size;
-            queue_base* const m_queue;
+            const thunk m_thunk;
+            job_pool* const m_pool;
+
+            //deallocates the memory of a job without locking;
+            //if the job was allocated from another queue's pool or from a shared pool,
+            //e.g. in case of stolen jobs, the memory is returned to the pool's remote free list
+            static void deallocate(job_pool* pool, void* mem, size_t size);
         };
 
         //job implementation.
         template <class F> class job_impl : public job {
         public:
             //constructor
-            job_impl(queue_base* q, F&& f) 
-                : job(sizeof(job_impl<F>), q), m_function(std::move(f))
+            template <class G> job_impl(job_pool* pool, G&& f) 
+                : job(&perform, pool), m_function(std::forward<G>(f))
             {
             }
 
-            //executes the function
-            void invoke() override {
-                m_function();
-            }
-
         private:
             //function to execute
             F m_function;
+
+            //executes the function, unless the job is cancelled, then deletes the job;
+            //if the function throws, the job is deleted by the fail operation
+            static bool perform(job* j, job_operation op, std::exception_ptr*) {
+                job_impl* self = static_cast<job_impl*>(j);
+                if (op == job_operation::execute) {
+                    self->m_function();
+                }
+                delete_job(self);
+                return false;
+            }
+        };
+
+        //function that invokes another function with an index.
+        template <class F> struct indexed_function {
+            //function to invoke
+            F function;
+
+            //index to pass to the function
+            size_t index;
+
+            //invokes the function with the index
+            void operator ()() {
+                function(index);
+            }
+        };
+
+        //result of a future; the value is stored in the job
+        template <class R> class future_result {
+        public:
+            //sets the result from the function
+            template <class F> void set(F& f) {
+                m_value.emplace(f());
+            }
+
+            //moves the value out of the result
+            R take() {
+                return std::move(*m_value);
+            }
+
+        private:
+            std::optional<R> m_value;
+        };
+
+        //result of a future of void
+        class future_void_result {
+        public:
+            //invokes the function
+            template <class F> void set(F& f) {
+                f();
+            }
+
+            //does nothing
+            void take() {
+            }
+        };
+
+        //job that contains the shared state of a future;
+        //it is deleted when both the job is executed and the future is released
+        template <class R> class future_job : public job {
+        public:
+            //result type
+            using result_type = R;
+
+            //constructor; there are two references, one for the job and one for the future
+            future_job(thunk t, job_pool* pool, executor* ex) 
+                : job(t, pool), m_executor(ex)
+            {
+            }
+
+            //releases one reference; the last reference deletes the job
+            void release() {
+                if (m_reference_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    perform(job_operation::destroy);
+                }
+            }
+
+        protected:
+            //sets the result from the function, then completes the job;
+            //if the function throws, the job is completed by the exception
+            template <class F> void complete(std::optional<F>& f) {
+                m_result.set(*f);
+                finish(f);
+            }
+
+            //stores the exception thrown by the function, then completes the job
+            template <class F> void complete_with_exception(std::optional<F>& f, std::exception_ptr e) {
+                m_exception = std::move(e);
+                finish(f);
+            }
+
+            //completes the discarded job with a broken promise error, since its function is not executed;
+            //the continuation, if there is one, is cancelled too, since the executor is shut down
+            template <class F> void cancel(std::optional<F>& f) {
+                m_exception = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+                f.reset();
+                job* continuation = m_continuation.exchange(completed(), std::memory_order_acq_rel);
+                notify_waiters();
+                if (continuation) {
+                    continuation->perform(job_operation::cancel);
+                }
+            }
+
+        private:
+            //the executor of the job
+            executor* const m_executor;
+
+            //continuation job, or the completed marker
+            std::atomic<job*> m_continuation{ nullptr };
+
+            //references to this
+            std::atomic<unsigned> m_reference_count{ 2 };
+
+            //completion state; threads waiting for the future block on it when there are no pending jobs
+            std::atomic<uint32_t> m_completion_state{ RUNNING };
+
+            //values of the completion state
+            static constexpr uint32_t RUNNING = 0;
+            static constexpr uint32_t WAITED = 1;
+            static constexpr uint32_t COMPLETED = 2;
+
+            //the result
+            std::conditional_t<std::is_void_v<R>, future_void_result, future_result<R>> m_result;
+
+            //the exception thrown by the function; rethrown by the future
+            std::exception_ptr m_exception;
+
+            //destroys the function, then schedules the continuation, if there is one
+            template <class F> void finish(std::optional<F>& f) {
+                f.reset();
+                job* continuation = m_continuation.exchange(completed(), std::memory_order_acq_rel);
+                notify_waiters();
+                if (continuation) {
+                    schedule_continuation(m_executor, continuation);
+                }
+            }
+
+            //sets the completion state; wakes up the threads blocked on it, if there are any;
+            //the future's reference keeps the job alive while they wait
+            void notify_waiters() {
+                if (m_completion_state.exchange(COMPLETED, std::memory_order_acq_rel) == WAITED) {
+                    wake_by_address_all(m_completion_state);
+                }
+            }
+
+            //blocks until the job completes, or until the timeout expires
+            void block(std::chrono::nanoseconds timeout) {
+                uint32_t state = RUNNING;
+                if (m_completion_state.compare_exchange_strong(state, WAITED, std::memory_order_acq_rel, std::memory_order_acquire) || state == WAITED) {
+                    wait_on_address(m_completion_state, WAITED, timeout);
+                }
+            }
+
+            //marker for completed jobs
+            static job* completed() {
+                return reinterpret_cast<job*>(std::uintptr_t(1));
+            }
+
+            //checks if the job is completed
+            bool is_completed() const {
+                return m_continuation.load(std::memory_order_acquire) == completed();
+            }
+
+            //sets the continuation; if the job is already completed, the continuation is scheduled immediately
+            void set_continuation(job* continuation) {
+                job* expected = nullptr;
+                if (!m_continuation.compare_exchange_strong(expected, continuation, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    schedule_continuation(m_executor, continuation);
+                }
+            }
+
+            template <class T> friend class execlib::future;
+            friend class executor;
         };
 
+        //future job implementation
+        template <class F> class future_job_impl : public future_job<std::decay_t<std::invoke_result_t<F&>>> {
+        public:
+            //constructor
+            template <class G> future_job_impl(job_pool* pool, G&& f, executor* ex)
+                : future_job<std::decay_t<std::invoke_result_t<F&>>>(&perform, pool, ex)
+                , m_function(std::forward<G>(f))
+            {
+            }
+
+        private:
+            //function to execute; destroyed after execution
+            std::optional<F> m_function;
+
+            //executes the function and completes the future, or completes it with the exception thrown by the function,
+            //then releases the job's reference; the future's reference keeps the job until the future is released
+            static bool perform(job* j, job_operation op, std::exception_ptr* e) {
+                future_job_impl* self = static_cast<future_job_impl*>(j);
+                switch (op) {
+                    case job_operation::execute:
+                        self->complete(self->m_function);
+                        break;
+
+                    case job_operation::fail:
+                        self->complete_with_exception(self->m_function, std::move(*e));
+                        break;
+
+                    case job_operation::cancel:
+                        self->cancel(self->m_function);
+                        break;
+
+                    case job_operation::destroy:
+                        job::delete_job(self);
+                        return true;
+                }
+                self->release();
+                return true;
+            }
+        };
+
+#ifdef EXECLIB_HAS_COROUTINES
+        //job that resumes a coroutine; it is embedded in an awaiter, which lives in the coroutine frame;
+        //it must not be accessed after being invoked, since the resumed coroutine may destroy it
+        class coroutine_job : public job {
+        public:
+            //constructor
+            coroutine_job() : job(&perform, nullptr) {}
+
+            //the coroutine to resume
+            std::coroutine_handle<> m_handle;
+
+        private:
+            //resumes the coroutine
+            static bool perform(job* j, job_operation op, std::exception_ptr*) {
+                if (op == job_operation::execute) {
+                    static_cast<coroutine_job*>(j)->m_handle.resume();
+                }
+                return false;
+            }
+        };
+#endif
+
+        //puts the continuation of a future job in the queue of the current worker thread,
+        //or in the next queue, if the current thread is not a worker thread of the executor
+        static void schedule_continuation(executor* ex, job* continuation);
+
+        template <class T> friend class execlib::future;
         friend class executor;
+        friend class execlib::task_group;
+        friend class execlib::task_graph;
+        friend class execlib::strand;
     };
 
 
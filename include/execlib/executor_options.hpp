@@ -0,0 +1,209 @@
+#ifndef EXECLIB_EXECUTOR_OPTIONS_HPP
+#define EXECLIB_EXECUTOR_OPTIONS_HPP
+
+
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <functional>
+
+
+namespace execlib {
+
+
+    /**
+     * Policy for jobs submitted from a worker thread of the same executor.
+     */
+    enum class nested_submission_policy {
+        /**
+         * The job is put in the current worker thread's queue, LIFO-style;
+         * other worker threads get it only by stealing.
+         */
+        local,
+
+        /**
+         * The job is put in the next queue, in round-robin fashion.
+         */
+        round_robin
+    };
+
+
+    /**
+     * Policy for worker threads that run out of jobs.
+     * 
+     * An idle worker thread first spins, looking for jobs between pause instructions,
+     * then yields to other threads, looking for jobs after each yield, then parks,
+     * until a job is put in its queue or there are jobs to steal.
+     * 
+     * Spinning avoids the cost of waking up a parked thread for latency-sensitive jobs,
+     * at the expense of cpu time.
+     */
+    struct idle_policy {
+        /**
+         * Number of attempts to find a job, separated by pause instructions, before yielding.
+         */
+        size_t spin_count = 256;
+
+        /**
+         * Number of attempts to find a job, separated by thread yields, before parking.
+         */
+        size_t yield_count = 16;
+    };
+
+
+    /**
+     * Order in which an idle worker thread tries other queues, when stealing jobs.
+     */
+    enum class victim_selection {
+        /**
+         * Queues are tried sequentially, starting from the next queue.
+         */
+        sequential,
+
+        /**
+         * Queues are tried in a random order, different for every attempt,
+         * so as that idle threads do not all compete for the same queue.
+         */
+        random,
+
+        /**
+         * As random, but queues of threads that share the same L3 cache are tried first,
+         * then queues of threads on the same numa node, then the rest.
+         */
+        locality
+    };
+
+
+    /**
+     * Policy for stealing jobs.
+     */
+    struct steal_policy {
+        /**
+         * Order of victim queues.
+         */
+        victim_selection victims = victim_selection::locality;
+
+        /**
+         * Number of rounds over all victim queues, before a steal attempt fails.
+         */
+        size_t round_count = 2;
+    };
+
+
+    /**
+     * Placement of worker threads on cpus.
+     */
+    enum class affinity_policy {
+        /**
+         * Worker threads are not pinned; the operating system places them.
+         */
+        none,
+
+        /**
+         * Worker thread i is pinned to the i-th cpu of thread_affinity::cpus, wrapping around.
+         */
+        cpu_list,
+
+        /**
+         * Each worker thread is pinned to a different physical core (to all its logical cpus),
+         * wrapping around when there are more threads than cores.
+         */
+        one_per_core,
+
+        /**
+         * Each worker thread is pinned to the cpus of a different L3 cache,
+         * wrapping around when there are more threads than L3 caches.
+         */
+        one_per_l3
+    };
+
+
+    /**
+     * Thread affinity options.
+     * 
+     * Pinned worker threads create their queue and its memory pools after being pinned,
+     * so as that the memory is first touched on the worker thread's numa node.
+     */
+    struct thread_affinity {
+        /**
+         * The placement policy.
+         */
+        affinity_policy policy = affinity_policy::none;
+
+        /**
+         * Operating system ids of cpus, for the cpu_list policy.
+         */
+        std::vector<unsigned> cpus;
+    };
+
+
+    /**
+     * Policy for worker threads released by executor::release_current_worker_thread.
+     * 
+     * A released thread that finishes its job waits for a queue to take over; if none becomes 
+     * available within the idle timeout, the thread terminates.
+     */
+    struct release_policy {
+        /**
+         * Maximum number of worker threads, including released ones; 0 for no limit.
+         * When the limit is reached and there is no idle released thread,
+         * a worker thread is not released.
+         */
+        size_t max_thread_count = 0;
+
+        /**
+         * Time a released thread waits for a queue before it terminates.
+         */
+        std::chrono::milliseconds idle_timeout{ 10000 };
+    };
+
+
+    /**
+     * Executor options.
+     */
+    struct executor_options {
+        /**
+         * Number of threads to use.
+         */
+        size_t thread_count = std::thread::hardware_concurrency();
+
+        /**
+         * Policy for jobs submitted from worker threads.
+         */
+        nested_submission_policy nested_submission = nested_submission_policy::local;
+
+        /**
+         * Policy for idle worker threads.
+         */
+        idle_policy idle;
+
+        /**
+         * Policy for stealing jobs.
+         */
+        steal_policy steal;
+
+        /**
+         * Placement of worker threads on cpus.
+         */
+        thread_affinity affinity;
+
+        /**
+         * Policy for released worker threads.
+         */
+        release_policy release;
+
+        /**
+         * Invoked with the exceptions thrown by jobs that have no future or task group to store them in;
+         * it is invoked from the thread that executed the job, which keeps running afterwards.
+         * It must not throw. If it is empty, the exceptions are ignored.
+         */
+        std::function<void(std::exception_ptr)> exception_handler;
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_EXECUTOR_OPTIONS_HPP
@@ -0,0 +1,124 @@
+#ifndef EXECLIB_EXECUTOR_STATS_HPP
+#define EXECLIB_EXECUTOR_STATS_HPP
+
+
+#include <cstddef>
+#include <chrono>
+#include <vector>
+
+
+namespace execlib {
+
+
+    /**
+     * Statistics of a worker thread.
+     */
+    struct worker_thread_stats {
+        /**
+         * True if the worker thread is released, i.e. it does not own a queue.
+         */
+        bool released = false;
+
+        /**
+         * Number of jobs executed by the worker thread.
+         */
+        size_t executed_job_count = 0;
+
+        /**
+         * Number of jobs stolen by the worker thread from other queues.
+         */
+        size_t stolen_job_count = 0;
+
+        /**
+         * Number of steal attempts that found no job.
+         */
+        size_t failed_steal_count = 0;
+
+        /**
+         * Number of times the worker thread parked.
+         */
+        size_t park_count = 0;
+
+        /**
+         * Number of times the worker thread was unparked.
+         */
+        size_t unpark_count = 0;
+
+        /**
+         * Time spent parked.
+         */
+        std::chrono::nanoseconds parked_time{};
+
+        /**
+         * Time spent finding and executing jobs, from the end of one idle period to the start of the next;
+         * the current busy period is not included.
+         */
+        std::chrono::nanoseconds busy_time{};
+    };
+
+
+    /**
+     * Statistics of a queue.
+     */
+    struct queue_stats {
+        /**
+         * Number of jobs stolen from the queue by other threads.
+         */
+        size_t stolen_from_job_count = 0;
+
+        /**
+         * Highest number of jobs that were pending in the queue at the same time.
+         */
+        size_t high_water_mark = 0;
+    };
+
+
+    /**
+     * Snapshot of the statistics of an executor.
+     *
+     * The counters are collected without synchronization, therefore a snapshot
+     * taken while jobs are executing is approximate.
+     */
+    struct executor_stats {
+        /**
+         * Number of worker threads, including released ones.
+         */
+        size_t worker_thread_count = 0;
+
+        /**
+         * Number of released worker threads; each one was replaced by another worker thread.
+         */
+        size_t released_worker_thread_count = 0;
+
+        /**
+         * Number of released worker threads that terminated after being idle for the idle timeout,
+         * since the executor was created; they are not included in the other statistics.
+         */
+        size_t reaped_worker_thread_count = 0;
+
+        /**
+         * Totals of all worker threads; 'released' is unused.
+         */
+        worker_thread_stats total;
+
+        /**
+         * Highest high water mark of all queues.
+         */
+        size_t queue_high_water_mark = 0;
+
+        /**
+         * Statistics of each worker thread, in order of creation.
+         */
+        std::vector<worker_thread_stats> worker_threads;
+
+        /**
+         * Statistics of each queue.
+         */
+        std::vector<queue_stats> queues;
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_EXECUTOR_STATS_HPP
@@ -0,0 +1,158 @@
+#ifndef EXECLIB_FUTURE_HPP
+#define EXECLIB_FUTURE_HPP
+
+
+#include <chrono>
+#include <utility>
+#include <type_traits>
+#include "executor.hpp"
+#include "wait_internals.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * A future for the result of a job.
+     * 
+     * It is returned from executor::execute(use_future, func).
+     * The shared state is stored in the job itself, and it is reference-counted:
+     * the job's memory is returned to its pool when both the job is executed and the future is released.
+     * 
+     * @param T type of result.
+     */
+    template <class T> class future {
+    public:
+        /**
+         * The default constructor.
+         * It creates an invalid future.
+         */
+        future() {
+        }
+
+        /**
+         * The move constructor.
+         * @param f the source future; it becomes invalid.
+         */
+        future(future&& f) : m_job(f.m_job) {
+            f.m_job = nullptr;
+        }
+
+        /**
+         * Releases the shared state.
+         * If the job is not executed yet, it is still executed.
+         */
+        ~future() {
+            reset();
+        }
+
+        /**
+         * The move assignment operator.
+         * @param f the source future; it becomes invalid.
+         * @return reference to this.
+         */
+        future& operator = (future&& f) {
+            if (&f != this) {
+                reset();
+                m_job = f.m_job;
+                f.m_job = nullptr;
+            }
+            return *this;
+        }
+
+        /**
+         * Checks if the future refers to a shared state.
+         * @return true if the future is valid, false otherwise.
+         */
+        bool valid() const {
+            return m_job != nullptr;
+        }
+
+        /**
+         * Checks if the result is available.
+         * @return true if the result is available, false otherwise.
+         */
+        bool ready() const {
+            return m_job->is_completed();
+        }
+
+        /**
+         * Waits for the result.
+         * While waiting, the current thread executes pending jobs of the job's executor,
+         * therefore it can be invoked from worker threads without deadlocking;
+         * when there are no pending jobs, it yields, then blocks for short periods, as in counter::wait(E&).
+         */
+        void wait() const {
+            wait_internals::help_while_waiting(*m_job->m_executor, [&]() { return ready(); }, [&](std::chrono::nanoseconds timeout) { m_job->block(timeout); });
+        }
+
+        /**
+         * Waits for the result, then returns it.
+         * The future becomes invalid.
+         * @return the result.
+         * @exception any exception thrown by the job's function is rethrown;
+         *  std::future_error with broken_promise is thrown if the job was discarded by the executor's shutdown.
+         */
+        T get() {
+            wait();
+            future f(std::move(*this));
+            if (f.m_job->m_exception) {
+                std::rethrow_exception(f.m_job->m_exception);
+            }
+            return f.m_job->m_result.take();
+        }
+
+        /**
+         * Adds a continuation to the future.
+         * 
+         * The continuation is put in the queue of the worker thread that completes this future,
+         * so as that it runs hot in the cache, without waking up another thread.
+         * 
+         * This future becomes invalid.
+         * 
+         * @param func continuation function; it is invoked with the result of this future,
+         *  or without arguments, for future<void>. If this future holds an exception, 
+         *  the continuation is not invoked, and its future holds the exception.
+         *  If this future's job is discarded by the executor's shutdown, the continuation is cancelled.
+         * @return a future for the result of the continuation.
+         */
+        template <class F> auto then(F&& func) {
+            executor_internals::future_job<T>* prev = m_job;
+            return prev->m_executor->new_continuation_job(prev, [f = std::move(*this), func = std::forward<F>(func)]() mutable {
+                if constexpr (std::is_void_v<T>) {
+                    f.get();
+                    return func();
+                }
+                else {
+                    return func(f.get());
+                }
+            });
+        }
+
+        future(const future&) = delete;
+        future& operator = (const future&) = delete;
+
+    private:
+        //the job with the shared state
+        executor_internals::future_job<T>* m_job = nullptr;
+
+        //constructor from job
+        future(executor_internals::future_job<T>* j) : m_job(j) {
+        }
+
+        //releases the shared state
+        void reset() {
+            if (m_job) {
+                m_job->release();
+                m_job = nullptr;
+            }
+        }
+
+        friend class executor;
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_FUTURE_HPP
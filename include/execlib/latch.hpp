@@ -0,0 +1,106 @@
+#ifndef EXECLIB_LATCH_HPP
+#define EXECLIB_LATCH_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include "address_wait.hpp"
+#include "wait_internals.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * A single-use countdown: threads wait until the count reaches zero.
+     * 
+     * Threads block on the address of the count (a futex on Linux); a bit of the count
+     * is set when there are waiting threads, and counting down does not make a system call unless it is set.
+     */
+    class latch {
+    public:
+        /**
+         * The constructor.
+         * @param count initial count.
+         */
+        explicit latch(uint32_t count) : m_word(count & COUNT_MASK) {
+        }
+
+        latch(const latch&) = delete;
+        latch& operator = (const latch&) = delete;
+
+        /**
+         * Decrements the count; if it reaches zero, the waiting threads are woken up.
+         * @param n value to subtract from the count.
+         */
+        void count_down(uint32_t n = 1) {
+            //the word is not accessed after the count reaches zero, since a waiter may destroy the latch;
+            //waking up threads only uses its address
+            if (m_word.fetch_sub(n) == (n | WAITERS_BIT)) {
+                wake_by_address_all(m_word);
+            }
+        }
+
+        /**
+         * Checks if the count is zero.
+         * @return true if the count is zero.
+         */
+        bool try_wait() const {
+            return (m_word.load(std::memory_order_acquire) & COUNT_MASK) == 0;
+        }
+
+        /**
+         * Waits until the count reaches zero.
+         */
+        void wait() const {
+            while (!try_wait()) {
+                block(std::chrono::nanoseconds::max());
+            }
+        }
+
+        /**
+         * Waits until the count reaches zero, while executing pending jobs of an executor; see counter::wait(E&).
+         * @param ex executor to execute pending jobs of; any type that provides execute_pending_job().
+         */
+        template <class E> void wait(E& ex) const {
+            wait_internals::help_while_waiting(ex, [&]() { return try_wait(); }, [&](std::chrono::nanoseconds timeout) { block(timeout); });
+        }
+
+        /**
+         * Decrements the count, then waits until it reaches zero.
+         * @param n value to subtract from the count.
+         */
+        void arrive_and_wait(uint32_t n = 1) {
+            count_down(n);
+            wait();
+        }
+
+    private:
+        //bit of the word that is set when there are waiting threads
+        static constexpr uint32_t WAITERS_BIT = uint32_t(1) << 31;
+
+        //bits of the word that contain the count
+        static constexpr uint32_t COUNT_MASK = WAITERS_BIT - 1;
+
+        //the count, and the waiters bit; threads block on it
+        mutable std::atomic<uint32_t> m_word;
+
+        //sets the waiters bit, then blocks while the word is unchanged
+        void block(std::chrono::nanoseconds timeout) const {
+            uint32_t word = m_word.load(std::memory_order_acquire);
+            if ((word & COUNT_MASK) == 0) {
+                return;
+            }
+            if (!(word & WAITERS_BIT) && !m_word.compare_exchange_strong(word, word | WAITERS_BIT)) {
+                return;
+            }
+            wait_on_address(m_word, word | WAITERS_BIT, timeout);
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_LATCH_HPP
@@ -0,0 +1,96 @@
+#ifndef EXECLIB_PARALLEL_FOR_HPP
+#define EXECLIB_PARALLEL_FOR_HPP
+
+
+#include "parallel_internals.hpp"
+
+
+namespace execlib {
+
+
+    namespace parallel_internals {
+
+
+        //executes the function for the range; while the range is larger than the grain,
+        //its upper half is forked as a new job, which splits its own range further when it runs,
+        //so as that stolen parts are split further by the thieves
+        template <class I, class F> void parallel_for_range(executor& ex, join_counter& jc, I begin, I end, const size_t grain, F& f) {
+            while ((size_t)(end - begin) > grain) {
+                const I middle = begin + (end - begin) / 2;
+                jc.fork();
+                ex.execute([&ex, &jc, middle, end, grain, &f]() {
+                    try {
+                        parallel_for_range(ex, jc, middle, end, grain, f);
+                    }
+                    catch (...) {
+                        jc.set_exception(std::current_exception());
+                    }
+                    jc.join();
+                });
+                end = middle;
+            }
+            for (; begin != end; ++begin) {
+                invoke_for(begin, f);
+            }
+        }
+
+
+    } //namespace parallel_internals
+
+
+    /**
+     * Executes a function for each element of a range, in parallel.
+     * 
+     * The range is split recursively, when jobs run: each job forks the upper half of its range
+     * until its range is not larger than the grain; stolen jobs are therefore split further by the thieves.
+     * 
+     * The calling thread participates in the execution, and it returns when all elements are processed.
+     * If the function throws, the jobs already forked complete, then one of the exceptions is rethrown.
+     * 
+     * @param ex executor to use.
+     * @param begin start of the range; an integral index or a random access iterator.
+     * @param end end of the range.
+     * @param grain maximum number of elements processed sequentially by a job; if 0, it is computed from the thread count.
+     * @param f function to execute; invoked with the index, for integral ranges, or with the element, for iterator ranges.
+     */
+    template <class I, class F> void parallel_for(executor& ex, I begin, I end, size_t grain, F&& f) {
+        if (!(begin < end)) {
+            return;
+        }
+
+        if (grain == 0) {
+            grain = parallel_internals::default_grain(ex, (size_t)(end - begin));
+        }
+
+        parallel_internals::join_counter jc;
+
+        //forked jobs reference the stack of this function; wait for them even if an exception is thrown
+        try {
+            parallel_internals::parallel_for_range(ex, jc, begin, end, grain, f);
+        }
+        catch (...) {
+            jc.wait(ex);
+            throw;
+        }
+
+        jc.wait(ex);
+        jc.rethrow_exception();
+    }
+
+
+    /**
+     * Executes a function for each element of a range, in parallel, with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the range; an integral index or a random access iterator.
+     * @param end end of the range.
+     * @param f function to execute; invoked with the index, for integral ranges, or with the element, for iterator ranges.
+     */
+    template <class I, class F> void parallel_for(executor& ex, I begin, I end, F&& f) {
+        parallel_for(ex, begin, end, 0, std::forward<F>(f));
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_FOR_HPP
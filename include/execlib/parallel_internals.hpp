@@ -0,0 +1,122 @@
+#ifndef EXECLIB_PARALLEL_INTERNALS_HPP
+#define EXECLIB_PARALLEL_INTERNALS_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include "executor.hpp"
+#include "atomic_counter.hpp"
+
+
+namespace execlib {
+
+
+    //internals of parallel algorithms
+    namespace parallel_internals {
+
+
+        //counts jobs forked by a parallel algorithm; lives on the stack of the caller,
+        //which waits for all the jobs to complete; it keeps the first exception thrown by a job
+        class join_counter {
+        public:
+            //adds a job
+            void fork() {
+                m_pending.increment();
+            }
+
+            //removes a job; the job's writes are released to the waiter, which is woken up if it is blocked
+            void join() {
+                m_pending.decrement_and_notify_all();
+            }
+
+            //stores the exception thrown by a job, if it is the first one; invoked before join()
+            void set_exception(std::exception_ptr e) {
+                if (!m_failed.exchange(true, std::memory_order_acq_rel)) {
+                    m_exception = std::move(e);
+                }
+            }
+
+            //waits for all jobs to complete, executing pending jobs while waiting;
+            //when there are no pending jobs, the thread blocks, as in counter::wait(E&)
+            void wait(executor& ex) {
+                m_pending.wait(ex);
+            }
+
+            //rethrows the first exception thrown by a job, if there is one; invoked after wait()
+            void rethrow_exception() {
+                if (m_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+        private:
+            //number of jobs not yet joined
+            atomic_counter<size_t> m_pending;
+
+            //set when a job throws; the first job to set it stores its exception
+            std::atomic<bool> m_failed{ false };
+
+            //the first exception thrown by a job
+            std::exception_ptr m_exception;
+        };
+
+
+        //invokes two functions in parallel: the second one is forked as a job, the first one is invoked
+        //by the calling thread, which then waits for the job while executing pending jobs, or blocked;
+        //the job references this stack frame, so it is waited for even if the first function throws.
+        //An exception thrown by the forked function is rethrown to the caller
+        template <class F1, class F2> void fork_join(executor& ex, F1&& f1, F2&& f2) {
+            join_counter jc;
+            jc.fork();
+            ex.execute([&f2, &jc]() {
+                try {
+                    f2();
+                }
+                catch (...) {
+                    jc.set_exception(std::current_exception());
+                }
+                jc.join();
+            });
+
+            try {
+                f1();
+            }
+            catch (...) {
+                jc.wait(ex);
+                throw;
+            }
+
+            jc.wait(ex);
+            jc.rethrow_exception();
+        }
+
+
+        //returns the default grain for a range: 8 chunks per thread
+        inline size_t default_grain(const executor& ex, size_t count) {
+            const size_t chunk_count = ex.thread_count() * 8;
+            return count > chunk_count ? count / chunk_count : 1;
+        }
+
+
+        //invokes the function for an element of a range; 
+        //for integral types, the function is invoked with the index, otherwise with the dereferenced iterator
+        template <class I, class F> void invoke_for(I i, F& f) {
+            if constexpr (std::is_integral_v<I>) {
+                f(i);
+            }
+            else {
+                f(*i);
+            }
+        }
+
+
+    } //namespace parallel_internals
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_INTERNALS_HPP
@@ -0,0 +1,98 @@
+#ifndef EXECLIB_PARALLEL_REDUCE_HPP
+#define EXECLIB_PARALLEL_REDUCE_HPP
+
+
+#include "parallel_internals.hpp"
+
+
+namespace execlib {
+
+
+    namespace parallel_internals {
+
+
+        //reduces the range; while the range is larger than the grain, its upper half is forked as a new job
+        //which writes its result to this stack frame; the lower half is reduced in place,
+        //then the results are combined in order; an exception thrown by either half is rethrown
+        template <class I, class T, class F, class R> T parallel_reduce_range(executor& ex, I begin, I end, const size_t grain, const T& identity, F& f, R& reduce) {
+            //small range: sequential
+            if ((size_t)(end - begin) <= grain) {
+                T result = identity;
+                for (; begin != end; ++begin) {
+                    if constexpr (std::is_integral_v<I>) {
+                        result = reduce(std::move(result), f(begin));
+                    }
+                    else {
+                        result = reduce(std::move(result), f(*begin));
+                    }
+                }
+                return result;
+            }
+
+            const I middle = begin + (end - begin) / 2;
+
+            //the upper half is reduced in a job, the lower half here; both results live in this stack frame
+            T lower_result = identity;
+            T upper_result = identity;
+            fork_join(ex,
+                [&]() { lower_result = parallel_reduce_range(ex, begin, middle, grain, identity, f, reduce); },
+                [&]() { upper_result = parallel_reduce_range(ex, middle, end, grain, identity, f, reduce); });
+
+            return reduce(std::move(lower_result), std::move(upper_result));
+        }
+
+
+    } //namespace parallel_internals
+
+
+    /**
+     * Reduces a range in parallel.
+     * 
+     * The range is split recursively, as in parallel_for; partial results are combined in range order,
+     * therefore the reduce function needs to be associative, but not commutative.
+     * 
+     * The calling thread participates in the execution, and waiting threads execute pending jobs.
+     * If a function throws, the jobs already forked complete, then one of the exceptions is rethrown.
+     * 
+     * @param ex executor to use.
+     * @param begin start of the range; an integral index or a random access iterator.
+     * @param end end of the range.
+     * @param grain maximum number of elements processed sequentially by a job; if 0, it is computed from the thread count.
+     * @param identity identity value of the reduction; it is the result for an empty range.
+     * @param f function that maps an element to the value to reduce; invoked with the index, 
+     *  for integral ranges, or with the element, for iterator ranges.
+     * @param reduce function that combines two values: reduce(T, T) -> T.
+     * @return the result of the reduction.
+     */
+    template <class I, class T, class F, class R> T parallel_reduce(executor& ex, I begin, I end, size_t grain, const T& identity, F&& f, R&& reduce) {
+        if (!(begin < end)) {
+            return identity;
+        }
+
+        if (grain == 0) {
+            grain = parallel_internals::default_grain(ex, (size_t)(end - begin));
+        }
+
+        return parallel_internals::parallel_reduce_range(ex, begin, end, grain, identity, f, reduce);
+    }
+
+
+    /**
+     * Reduces a range in parallel, with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the range; an integral index or a random access iterator.
+     * @param end end of the range.
+     * @param identity identity value of the reduction.
+     * @param f function that maps an element to the value to reduce.
+     * @param reduce function that combines two values.
+     * @return the result of the reduction.
+     */
+    template <class I, class T, class F, class R> T parallel_reduce(executor& ex, I begin, I end, const T& identity, F&& f, R&& reduce) {
+        return parallel_reduce(ex, begin, end, 0, identity, std::forward<F>(f), std::forward<R>(reduce));
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_REDUCE_HPP
@@ -0,0 +1,96 @@
+#ifndef EXECLIB_PARALLEL_SCAN_HPP
+#define EXECLIB_PARALLEL_SCAN_HPP
+
+
+#include <algorithm>
+#include <vector>
+#include "parallel_for.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * Computes the inclusive prefix sums of a range in parallel: the n-th output element
+     * is the reduction of the first n + 1 input elements.
+     *
+     * The range is divided in chunks of the grain's size; the chunks are reduced in parallel,
+     * the chunk results are combined sequentially into the prefix of each chunk,
+     * then the chunks are scanned in parallel, starting from their prefix.
+     * The reduce function is therefore invoked about twice per element; it needs to be associative,
+     * but not commutative.
+     *
+     * The output range may be the input range. The calling thread participates in the execution.
+     *
+     * @param ex executor to use.
+     * @param begin start of the input range; a random access iterator.
+     * @param end end of the input range.
+     * @param out start of the output range; a random access iterator.
+     * @param grain number of elements of a chunk; if 0, it is computed from the thread count.
+     * @param identity identity value of the reduction.
+     * @param reduce function that combines two values: reduce(T, T) -> T.
+     * @return the end of the output range.
+     */
+    template <class I, class O, class T, class R> O parallel_scan(executor& ex, I begin, I end, O out, size_t grain, const T& identity, R&& reduce) {
+        if (!(begin < end)) {
+            return out;
+        }
+
+        const size_t count = (size_t)(end - begin);
+
+        if (grain == 0) {
+            grain = parallel_internals::default_grain(ex, count);
+        }
+
+        const size_t chunk_count = (count + grain - 1) / grain;
+
+        //the reductions of the chunks; the last chunk is not needed
+        std::vector<T> prefixes(chunk_count, identity);
+        parallel_for(ex, size_t(0), chunk_count - 1, size_t(1), [&](size_t chunk) {
+            T result = identity;
+            for (size_t index = chunk * grain, chunk_end = index + grain; index < chunk_end; ++index) {
+                result = reduce(std::move(result), begin[index]);
+            }
+            prefixes[chunk] = std::move(result);
+        });
+
+        //the prefix of each chunk
+        T prefix = identity;
+        for (T& chunk_result : prefixes) {
+            T next_prefix = reduce(prefix, std::move(chunk_result));
+            chunk_result = std::move(prefix);
+            prefix = std::move(next_prefix);
+        }
+
+        //the scan of each chunk, from its prefix
+        parallel_for(ex, size_t(0), chunk_count, size_t(1), [&](size_t chunk) {
+            T result = prefixes[chunk];
+            for (size_t index = chunk * grain, chunk_end = std::min(index + grain, count); index < chunk_end; ++index) {
+                result = reduce(std::move(result), begin[index]);
+                out[index] = result;
+            }
+        });
+
+        return out + count;
+    }
+
+
+    /**
+     * Computes the inclusive prefix sums of a range in parallel, with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the input range; a random access iterator.
+     * @param end end of the input range.
+     * @param out start of the output range; a random access iterator.
+     * @param identity identity value of the reduction.
+     * @param reduce function that combines two values: reduce(T, T) -> T.
+     * @return the end of the output range.
+     */
+    template <class I, class O, class T, class R> O parallel_scan(executor& ex, I begin, I end, O out, const T& identity, R&& reduce) {
+        return parallel_scan(ex, begin, end, out, 0, identity, std::forward<R>(reduce));
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_SCAN_HPP
@@ -0,0 +1,143 @@
+#ifndef EXECLIB_PARALLEL_SORT_HPP
+#define EXECLIB_PARALLEL_SORT_HPP
+
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "parallel_internals.hpp"
+
+
+namespace execlib {
+
+
+    namespace parallel_internals {
+
+
+        //merges two sorted ranges into the output, moving the elements; while the ranges are larger than the grain,
+        //the larger one is split at its middle and the other one at the matching position,
+        //and the upper parts are merged by a forked job; equal elements of the first range are put first
+        template <class I, class O, class C> void parallel_merge_range(executor& ex, I begin1, I end1, I begin2, I end2, O out, const size_t grain, C& comp) {
+            const size_t count1 = (size_t)(end1 - begin1);
+            const size_t count2 = (size_t)(end2 - begin2);
+
+            //small ranges are merged sequentially; splitting needs two elements in the larger range
+            if (count1 + count2 <= grain || std::max(count1, count2) < 2) {
+                std::merge(std::make_move_iterator(begin1), std::make_move_iterator(end1), std::make_move_iterator(begin2), std::make_move_iterator(end2), out, comp);
+                return;
+            }
+
+            I middle1, middle2;
+            if (count1 >= count2) {
+                middle1 = begin1 + count1 / 2;
+                middle2 = std::lower_bound(begin2, end2, *middle1, comp);
+            }
+            else {
+                middle2 = begin2 + count2 / 2;
+                middle1 = std::upper_bound(begin1, end1, *middle2, comp);
+            }
+            const O out_middle = out + (middle1 - begin1) + (middle2 - begin2);
+
+            fork_join(ex,
+                [&]() { parallel_merge_range(ex, begin1, middle1, begin2, middle2, out, grain, comp); },
+                [&]() { parallel_merge_range(ex, middle1, end1, middle2, end2, out_middle, grain, comp); });
+        }
+
+
+        //sorts the range; the result is left in the range, or moved to the buffer if to_buffer is set.
+        //While the range is larger than the grain, its halves are sorted in parallel into the other storage,
+        //then merged into the target one; the ranges that are not split are sorted in place
+        template <class I, class B, class C> void parallel_sort_range(executor& ex, I begin, I end, B buffer, const bool to_buffer, const size_t grain, C& comp) {
+            const size_t count = (size_t)(end - begin);
+
+            if (count <= grain) {
+                std::sort(begin, end, comp);
+                if (to_buffer) {
+                    std::move(begin, end, buffer);
+                }
+                return;
+            }
+
+            const I middle = begin + count / 2;
+            const B buffer_middle = buffer + count / 2;
+
+            fork_join(ex,
+                [&]() { parallel_sort_range(ex, begin, middle, buffer, !to_buffer, grain, comp); },
+                [&]() { parallel_sort_range(ex, middle, end, buffer_middle, !to_buffer, grain, comp); });
+
+            if (to_buffer) {
+                parallel_merge_range(ex, begin, middle, middle, end, buffer, grain, comp);
+            }
+            else {
+                parallel_merge_range(ex, buffer, buffer_middle, buffer_middle, buffer + count, begin, grain, comp);
+            }
+        }
+
+
+    } //namespace parallel_internals
+
+
+    /**
+     * Sorts a range in parallel (a parallel merge sort).
+     *
+     * The range is split recursively as in parallel_for; the parts that are not larger than the grain
+     * are sorted with std::sort, and the sorted parts are merged in parallel: large merges are split
+     * by binary search, so as that the last merges do not run on a single thread.
+     *
+     * The sort is not stable. It uses a buffer of the range's size; elements must be default constructible
+     * and move assignable. The calling thread participates in the execution.
+     *
+     * @param ex executor to use.
+     * @param begin start of the range; a random access iterator.
+     * @param end end of the range.
+     * @param grain maximum number of elements sorted or merged sequentially by a job; if 0, it is computed from the thread count.
+     * @param comp comparison function, as in std::sort.
+     */
+    template <class I, class C> void parallel_sort(executor& ex, I begin, I end, size_t grain, C&& comp) {
+        if (!(begin < end)) {
+            return;
+        }
+
+        const size_t count = (size_t)(end - begin);
+
+        if (grain == 0) {
+            grain = parallel_internals::default_grain(ex, count);
+        }
+
+        if (count <= grain) {
+            std::sort(begin, end, comp);
+            return;
+        }
+
+        std::vector<typename std::iterator_traits<I>::value_type> buffer(count);
+        parallel_internals::parallel_sort_range(ex, begin, end, buffer.begin(), false, grain, comp);
+    }
+
+
+    /**
+     * Sorts a range in parallel, with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the range; a random access iterator.
+     * @param end end of the range.
+     * @param comp comparison function, as in std::sort.
+     */
+    template <class I, class C> void parallel_sort(executor& ex, I begin, I end, C&& comp) {
+        parallel_sort(ex, begin, end, 0, std::forward<C>(comp));
+    }
+
+
+    /**
+     * Sorts a range in parallel, in ascending order, with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the range; a random access iterator.
+     * @param end end of the range.
+     */
+    template <class I> void parallel_sort(executor& ex, I begin, I end) {
+        parallel_sort(ex, begin, end, 0, std::less<>());
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_SORT_HPP
@@ -0,0 +1,57 @@
+#ifndef EXECLIB_PARALLEL_TRANSFORM_HPP
+#define EXECLIB_PARALLEL_TRANSFORM_HPP
+
+
+#include "parallel_for.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * Applies a function to each element of a range and stores the results in an output range, in parallel.
+     *
+     * The range is split as in parallel_for. The output range may be the input range.
+     *
+     * @param ex executor to use.
+     * @param begin start of the input range; a random access iterator.
+     * @param end end of the input range.
+     * @param out start of the output range; a random access iterator.
+     * @param grain maximum number of elements processed sequentially by a job; if 0, it is computed from the thread count.
+     * @param f function to apply; invoked with an element of the input range.
+     * @return the end of the output range.
+     */
+    template <class I, class O, class F> O parallel_transform(executor& ex, I begin, I end, O out, size_t grain, F&& f) {
+        if (!(begin < end)) {
+            return out;
+        }
+
+        const size_t count = (size_t)(end - begin);
+
+        parallel_for(ex, size_t(0), count, grain, [&](size_t index) {
+            out[index] = f(begin[index]);
+        });
+
+        return out + count;
+    }
+
+
+    /**
+     * Applies a function to each element of a range and stores the results in an output range, in parallel,
+     * with a grain computed from the thread count.
+     * @param ex executor to use.
+     * @param begin start of the input range; a random access iterator.
+     * @param end end of the input range.
+     * @param out start of the output range; a random access iterator.
+     * @param f function to apply; invoked with an element of the input range.
+     * @return the end of the output range.
+     */
+    template <class I, class O, class F> O parallel_transform(executor& ex, I begin, I end, O out, F&& f) {
+        return parallel_transform(ex, begin, end, out, 0, std::forward<F>(f));
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_PARALLEL_TRANSFORM_HPP
@@ -0,0 +1,259 @@
+#ifndef EXECLIB_STRAND_HPP
+#define EXECLIB_STRAND_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <exception>
+#include <utility>
+#include <type_traits>
+#include "executor.hpp"
+#include "atomic_counter.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * Executes jobs one at a time, in the order they are submitted, on the worker threads of an executor
+     * (a serial executor). It protects the state that its jobs share without a mutex: no thread blocks
+     * waiting for another one, and submitting a job from a job of the strand does not deadlock.
+     *
+     * Jobs are pushed to a lock-free list. The submission that finds the strand idle puts a drain job
+     * in a queue of the executor; the drain job takes the list in one step and executes its jobs,
+     * one batch at a time. After a batch, if there are jobs left, the drain job is put in a queue again,
+     * so as that the worker thread goes back to its loop; otherwise the strand becomes idle.
+     * The jobs of a batch are executed by the same thread, which keeps the state they share in its caches.
+     *
+     * Exceptions thrown by jobs are passed to the executor's exception handler; the next jobs are executed.
+     */
+    class strand {
+    public:
+        /**
+         * The constructor.
+         * @param ex executor to execute the jobs of the strand.
+         * @param priority priority of the drain job.
+         * @param batch_size number of jobs executed before the drain job is put in a queue again.
+         */
+        explicit strand(executor& ex, job_priority priority = job_priority::normal, size_t batch_size = 64)
+            : m_executor(ex), m_priority(priority), m_batch_size(batch_size > 0 ? batch_size : 1)
+        {
+        }
+
+        strand(const strand&) = delete;
+        strand& operator = (const strand&) = delete;
+
+        /**
+         * Waits for the jobs of the strand to complete.
+         */
+        ~strand() {
+            m_pending_job_count.wait(m_executor);
+        }
+
+        /**
+         * Executes a function as a job of the strand, after the jobs submitted before it.
+         * The job's memory is allocated as in executor::execute(func).
+         * @param func function to execute.
+         */
+        template <class F> void execute(F&& func) {
+            m_pending_job_count.increment();
+            push(m_executor.allocate_job<strand_job<std::decay_t<F>>>(std::forward<F>(func)));
+        }
+
+        /**
+         * Waits for the jobs submitted to the strand to complete, while executing pending jobs of the executor.
+         */
+        void wait() {
+            m_pending_job_count.wait(m_executor);
+        }
+
+    private:
+        using job = executor_internals::job;
+        using job_pool = executor_internals::job_pool;
+        using job_operation = executor_internals::job_operation;
+
+        //job of a strand; it is linked in the strand's list
+        class node : public job {
+        public:
+            //constructor
+            node(thunk t, job_pool* pool) : job(t, pool) {}
+
+            //next job; in the pushed list, it is the job pushed before this one
+            node* m_next = nullptr;
+        };
+
+        //job of a strand with a function
+        template <class F> class strand_job : public node {
+        public:
+            //constructor
+            template <class G> strand_job(job_pool* pool, G&& f) : node(&perform, pool), m_function(std::forward<G>(f)) {}
+
+        private:
+            //function to execute
+            F m_function;
+
+            //executes the function, unless the job is cancelled, then deletes the job;
+            //if the function throws, the job is deleted by the fail operation
+            static bool perform(job* j, job_operation op, std::exception_ptr*) {
+                strand_job* self = static_cast<strand_job*>(j);
+                if (op == job_operation::execute) {
+                    self->m_function();
+                }
+                delete_job(self);
+                return false;
+            }
+        };
+
+        //job that executes the jobs of a strand; it is allocated whenever the strand stops being idle
+        class drain_job : public job {
+        public:
+            //constructor
+            drain_job(job_pool* pool, strand* s) : job(&perform, pool), m_strand(s) {}
+
+        private:
+            //the strand
+            strand* const m_strand;
+
+            //executes a batch of jobs; the job is put in a queue again if there are jobs left.
+            //If the drain job is discarded by the executor's shutdown, the jobs of the strand are discarded too
+            static bool perform(job* j, job_operation op, std::exception_ptr*) {
+                drain_job* self = static_cast<drain_job*>(j);
+                switch (op) {
+                    case job_operation::execute:
+                        if (self->m_strand->drain()) {
+                            self->m_strand->m_executor.schedule_job(self, self->m_strand->m_priority);
+                            return true;
+                        }
+                        break;
+
+                    case job_operation::cancel:
+                        self->m_strand->discard();
+                        break;
+
+                    case job_operation::fail:
+                    case job_operation::destroy:
+                        break;
+                }
+                delete_job(self);
+                return false;
+            }
+        };
+
+        //the executor of the jobs
+        executor& m_executor;
+
+        //priority of the drain job
+        const job_priority m_priority;
+
+        //number of jobs of a batch
+        const size_t m_batch_size;
+
+        //the pushed jobs, newest first; null when the strand is idle, or busy() when a drain job
+        //owns the strand and there are no pushed jobs
+        std::atomic<node*> m_head{ nullptr };
+
+        //the jobs taken from the pushed list, oldest first; accessed only by the drain job
+        node* m_batch = nullptr;
+
+        //number of jobs not yet completed; the drain job subtracts the jobs it executed
+        //after it is done with the strand, since then the strand may be destroyed
+        atomic_counter<size_t> m_pending_job_count;
+
+        //marker of a busy strand without pushed jobs; it is never dereferenced
+        static node* busy() {
+            return reinterpret_cast<node*>(uintptr_t(1));
+        }
+
+        //pushes a job; if the strand was idle, a drain job is put in a queue;
+        //the push synchronizes with the drain job that made the strand idle
+        void push(node* n) {
+            node* head = m_head.load(std::memory_order_relaxed);
+            do {
+                n->m_next = head;
+            } while (!m_head.compare_exchange_weak(head, n, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+            if (!head) {
+                m_executor.schedule_job(m_executor.allocate_job<drain_job>(this), m_priority);
+            }
+        }
+
+        //reverses a pushed list, which ends with null or busy()
+        static node* reverse(node* list) {
+            node* result = nullptr;
+            while (list && list != busy()) {
+                node* next = list->m_next;
+                list->m_next = result;
+                result = list;
+                list = next;
+            }
+            return result;
+        }
+
+        //takes the pushed jobs, if the batch is empty; if there are none, the strand becomes idle,
+        //unless jobs are pushed meanwhile; returns false if the strand became idle
+        bool fill_batch() {
+            if (m_batch) {
+                return true;
+            }
+            for (;;) {
+                node* list = m_head.exchange(busy(), std::memory_order_acq_rel);
+                if (list != busy()) {
+                    m_batch = reverse(list);
+                    return true;
+                }
+                node* expected = busy();
+                if (m_head.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    return false;
+                }
+            }
+        }
+
+        //executes a job; its exception is passed to the executor's exception handler
+        void execute_job(node* n) {
+            try {
+                n->perform(job_operation::execute);
+            }
+            catch (...) {
+                std::exception_ptr e = std::current_exception();
+                if (!n->perform(job_operation::fail, &e)) {
+                    m_executor.handle_exception(std::move(e));
+                }
+            }
+        }
+
+        //executes a batch of jobs; returns true if there are jobs left, false if the strand became idle
+        bool drain() {
+            size_t completed = 0;
+            while (fill_batch()) {
+                if (completed == m_batch_size) {
+                    m_pending_job_count.decrement_and_notify_all(completed);
+                    return true;
+                }
+                node* n = m_batch;
+                m_batch = n->m_next;
+                execute_job(n);
+                ++completed;
+            }
+            m_pending_job_count.decrement_and_notify_all(completed);
+            return false;
+        }
+
+        //destroys the jobs of the strand without executing them, then the strand becomes idle
+        void discard() {
+            size_t discarded = 0;
+            while (fill_batch()) {
+                node* n = m_batch;
+                m_batch = n->m_next;
+                n->perform(job_operation::cancel);
+                ++discarded;
+            }
+            m_pending_job_count.decrement_and_notify_all(discarded);
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_STRAND_HPP
@@ -0,0 +1,300 @@
+#ifndef EXECLIB_TASK_GRAPH_HPP
+#define EXECLIB_TASK_GRAPH_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <exception>
+#include <utility>
+#include <type_traits>
+#include "executor.hpp"
+#include "atomic_counter.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * A graph of jobs with dependencies (a DAG), executed by an executor.
+     *
+     * Each node counts its predecessors; when a node finishes, it decrements the counts of its successors,
+     * and the successors that become ready are put in the current worker thread's queue,
+     * except for one, which is executed next by the same thread, without going through a queue.
+     * No thread blocks while the graph runs.
+     *
+     * The graph is reusable: each node embeds the job that executes it, therefore running the graph
+     * again does not allocate memory. The graph must not be modified, or run again, while it runs.
+     *
+     * The first exception thrown by a node is stored and rethrown by wait(); the functions of the nodes
+     * that are not started yet are skipped then, but the run completes as usual.
+     * If the executor is shut down with shutdown_mode::discard, the nodes that have not started are skipped,
+     * and the run completes too.
+     */
+    class task_graph {
+    public:
+        /**
+         * A node of the graph; it is created by task_graph::add.
+         */
+        class node : protected executor_internals::job {
+        public:
+            /**
+             * Makes the given node a successor of this one: it runs after this node finishes.
+             * @param successor the successor node; it must belong to the same graph.
+             * @return reference to this.
+             */
+            node& precede(node& successor) {
+                m_successors.push_back(&successor);
+                ++successor.m_predecessor_count;
+                return *this;
+            }
+
+            /**
+             * Makes the given node a predecessor of this one: this node runs after it finishes.
+             * @param predecessor the predecessor node; it must belong to the same graph.
+             * @return reference to this.
+             */
+            node& succeed(node& predecessor) {
+                predecessor.precede(*this);
+                return *this;
+            }
+
+            node(const node&) = delete;
+            node& operator = (const node&) = delete;
+
+        protected:
+            //function that invokes the function of a node
+            using run_function = void (*)(node* n);
+
+            //constructor; the job is embedded in the node, therefore it is never released by the executor;
+            //the thunk and the run function are the ones of the node's type
+            node(task_graph* graph, thunk t, run_function run) : job(t, nullptr), m_graph(graph), m_run(run) {}
+
+            //the graph the node belongs to
+            task_graph* const m_graph;
+
+        private:
+            //invokes the function of the node; used for the nodes that are executed without going through a queue
+            const run_function m_run;
+
+            //nodes that run after this one
+            std::vector<node*> m_successors;
+
+            //number of predecessors
+            size_t m_predecessor_count = 0;
+
+            //predecessors that have not finished in the current run
+            std::atomic<size_t> m_remaining_predecessor_count{ 0 };
+
+            friend class task_graph;
+        };
+
+        /**
+         * The constructor.
+         * @param ex executor to run the graph on.
+         * @param priority priority of the jobs of the nodes.
+         */
+        explicit task_graph(executor& ex, job_priority priority = job_priority::normal)
+            : m_executor(ex), m_priority(priority)
+        {
+        }
+
+        task_graph(const task_graph&) = delete;
+        task_graph& operator = (const task_graph&) = delete;
+
+        /**
+         * Waits for the current run to complete; an exception stored in the graph is not rethrown.
+         */
+        ~task_graph() {
+            m_pending_node_count.wait(m_executor);
+        }
+
+        /**
+         * Adds a node to the graph.
+         * @param func function of the node; it is invoked once per run.
+         * @return reference to the node; it remains valid as long as the graph exists.
+         */
+        template <class F> node& add(F&& func) {
+            m_nodes.push_back(std::unique_ptr<node, node_deleter>(new node_impl<std::decay_t<F>>(this, std::forward<F>(func))));
+            return *m_nodes.back();
+        }
+
+        /**
+         * Returns the number of nodes.
+         * @return the number of nodes.
+         */
+        size_t size() const {
+            return m_nodes.size();
+        }
+
+        /**
+         * Starts running the graph: the nodes without predecessors are put in queues of the executor;
+         * it does not wait for the graph to complete.
+         * The graph must not have cycles.
+         */
+        void run() {
+            //all counts are set before the first node is put in a queue
+            m_pending_node_count += m_nodes.size();
+            for (const std::unique_ptr<node, node_deleter>& n : m_nodes) {
+                n->m_remaining_predecessor_count.store(n->m_predecessor_count, std::memory_order_relaxed);
+            }
+            for (const std::unique_ptr<node, node_deleter>& n : m_nodes) {
+                if (n->m_predecessor_count == 0) {
+                    m_executor.schedule_job(n.get(), m_priority);
+                }
+            }
+        }
+
+        /**
+         * Waits for the current run to complete, while executing pending jobs of the executor.
+         * @exception the first exception thrown by a node in the run, if there is one.
+         */
+        void wait() {
+            m_pending_node_count.wait(m_executor);
+            if (m_failed.load(std::memory_order_acquire)) {
+                std::exception_ptr e = std::move(m_exception);
+                m_exception = nullptr;
+                m_failed.store(false, std::memory_order_relaxed);
+                std::rethrow_exception(e);
+            }
+        }
+
+        /**
+         * Runs the graph and waits for it to complete.
+         * @exception the first exception thrown by a node, if there is one.
+         */
+        void run_and_wait() {
+            run();
+            wait();
+        }
+
+    private:
+        //node implementation
+        template <class F> class node_impl : public node {
+        public:
+            //constructor
+            template <class G> node_impl(task_graph* graph, G&& f) : node(graph, &perform, &run), m_function(std::forward<G>(f)) {}
+
+        private:
+            //function of the node
+            F m_function;
+
+            //executes the node, invoking its function directly, then its successors that become ready;
+            //if the node is discarded by the executor's shutdown, it is cancelled, along with the nodes that depend on it
+            static bool perform(job* j, executor_internals::job_operation op, std::exception_ptr*) {
+                node_impl* self = static_cast<node_impl*>(j);
+                switch (op) {
+                    case executor_internals::job_operation::execute:
+                        self->m_graph->execute(self, self->m_function);
+                        break;
+
+                    case executor_internals::job_operation::cancel:
+                        self->m_graph->cancel(self);
+                        break;
+
+                    case executor_internals::job_operation::destroy:
+                        delete self;
+                        break;
+
+                    case executor_internals::job_operation::fail:
+                        break;
+                }
+                return false;
+            }
+
+            //invokes the function of a node of this type
+            static void run(node* n) {
+                static_cast<node_impl*>(n)->m_function();
+            }
+        };
+
+        //deletes a node, through its thunk, since its type is known only to the thunk
+        struct node_deleter {
+            void operator ()(node* n) const {
+                n->perform(executor_internals::job_operation::destroy);
+            }
+        };
+
+        //the executor of the graph
+        executor& m_executor;
+
+        //priority of the jobs of the nodes
+        const job_priority m_priority;
+
+        //the nodes
+        std::vector<std::unique_ptr<node, node_deleter>> m_nodes;
+
+        //nodes that have not finished in the current run
+        atomic_counter<size_t> m_pending_node_count;
+
+        //set when a node throws; the first thread to set it stores its exception
+        std::atomic<bool> m_failed{ false };
+
+        //the first exception thrown by a node; read after the run completes
+        std::exception_ptr m_exception;
+
+        //invokes the function of a node, unless a node of the run failed; the first exception is stored
+        template <class F> void run_node(F&& func) {
+            if (!m_failed.load(std::memory_order_relaxed)) {
+                try {
+                    func();
+                }
+                catch (...) {
+                    if (!m_failed.exchange(true, std::memory_order_acq_rel)) {
+                        m_exception = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        //completes a node whose function was invoked: of the successors that become ready, the last one is returned,
+        //to be executed next by this thread, and the others are put in the current worker thread's queue
+        node* finish(node* n) {
+            node* next = nullptr;
+            for (node* successor : n->m_successors) {
+                if (successor->m_remaining_predecessor_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    if (next) {
+                        m_executor.schedule_job(next, m_priority);
+                    }
+                    next = successor;
+                }
+            }
+            m_pending_node_count.decrement_and_notify_all();
+            return next;
+        }
+
+        //executes a node taken from a queue, whose function is invoked directly, then the successors that become ready,
+        //whose functions are invoked through their run functions; the graph is not accessed
+        //after its last node finishes, since it may be destroyed then
+        template <class F> void execute(node* n, F& func) {
+            run_node(func);
+            n = finish(n);
+            while (n) {
+                run_node([n]() { n->m_run(n); });
+                n = finish(n);
+            }
+        }
+
+        //completes a cancelled node, and the successors that become ready, without running them;
+        //the successors are not put in queues, since the executor is shut down
+        void cancel(node* n) {
+            std::vector<node*> cancelled{ n };
+            while (!cancelled.empty()) {
+                n = cancelled.back();
+                cancelled.pop_back();
+                for (node* successor : n->m_successors) {
+                    if (successor->m_remaining_predecessor_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        cancelled.push_back(successor);
+                    }
+                }
+                m_pending_node_count.decrement_and_notify_all();
+            }
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_TASK_GRAPH_HPP
@@ -0,0 +1,213 @@
+#ifndef EXECLIB_TASK_GROUP_HPP
+#define EXECLIB_TASK_GROUP_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <optional>
+#include <exception>
+#include <utility>
+#include <type_traits>
+#include "executor.hpp"
+#include "atomic_counter.hpp"
+
+
+namespace execlib {
+
+
+    /**
+     * Allows a running job to check if the task group it belongs to was cancelled.
+     * It is cheap to copy; it must not be used after the task group is destroyed.
+     */
+    class cancellation_token {
+    public:
+        /**
+         * Creates a token that is never cancelled.
+         */
+        cancellation_token() = default;
+
+        /**
+         * Checks if cancellation was requested.
+         * @return true if the task group was cancelled.
+         */
+        bool is_cancelled() const {
+            return m_cancelled && m_cancelled->load(std::memory_order_acquire);
+        }
+
+    private:
+        const std::atomic<bool>* m_cancelled = nullptr;
+
+        cancellation_token(const std::atomic<bool>* cancelled) : m_cancelled(cancelled) {}
+
+        friend class task_group;
+    };
+
+
+    /**
+     * A group of jobs that can be waited for and cancelled together.
+     *
+     * Jobs of a cancelled group that have not started are not invoked: the worker thread that dequeues them
+     * destroys their function and returns their memory; running jobs may poll the group's cancellation token
+     * and return early. A cancelled group stays cancelled; jobs put in it afterwards are skipped as well.
+     *
+     * The group counts its pending jobs; wait() executes pending jobs of the executor
+     * while they complete, instead of blocking.
+     *
+     * The first exception thrown by a job of the group is stored in the group and rethrown by wait();
+     * the group is cancelled then, so as that the rest of its jobs are skipped.
+     */
+    class task_group {
+    public:
+        /**
+         * The constructor.
+         * @param ex executor to execute the jobs of the group.
+         */
+        explicit task_group(executor& ex) : m_executor(ex) {
+        }
+
+        task_group(const task_group&) = delete;
+        task_group& operator = (const task_group&) = delete;
+
+        /**
+         * Waits for the jobs of the group to complete or to be skipped.
+         * An exception stored in the group is not rethrown.
+         */
+        ~task_group() {
+            m_pending_job_count.wait(m_executor);
+        }
+
+        /**
+         * Executes a function as a job of the group; the job is scheduled as in executor::execute(func).
+         * @param func function to execute.
+         * @param priority priority of the job.
+         */
+        template <class F> void run(F&& func, job_priority priority = job_priority::normal) {
+            m_pending_job_count.increment();
+            m_executor.put_new_job<group_job<std::decay_t<F>>>(priority, std::forward<F>(func), this);
+        }
+
+        /**
+         * Requests cancellation: jobs of the group that have not started are skipped,
+         * and the cancellation token of the group is set.
+         */
+        void cancel() {
+            m_cancelled.store(true, std::memory_order_release);
+        }
+
+        /**
+         * Checks if the group was cancelled.
+         * @return true if cancel() was invoked.
+         */
+        bool is_cancelled() const {
+            return m_cancelled.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Returns a token that running jobs can poll for cancellation.
+         * @return the cancellation token of this group.
+         */
+        cancellation_token token() const {
+            return cancellation_token(&m_cancelled);
+        }
+
+        /**
+         * Waits for the jobs of the group to complete or to be skipped,
+         * while executing pending jobs of the executor.
+         * @exception the first exception thrown by a job of the group, if there is one; 
+         *  it is rethrown once.
+         */
+        void wait() {
+            m_pending_job_count.wait(m_executor);
+            if (m_failed.load(std::memory_order_acquire)) {
+                std::exception_ptr e = std::move(m_exception);
+                m_exception = nullptr;
+                m_failed.store(false, std::memory_order_relaxed);
+                std::rethrow_exception(e);
+            }
+        }
+
+    private:
+        //job of a group; its function is destroyed before the group is notified,
+        //since the group may be destroyed as soon as its last job completes
+        template <class F> class group_job : public executor_internals::job {
+        public:
+            //constructor
+            template <class G> group_job(executor_internals::job_pool* pool, G&& f, task_group* group)
+                : job(&perform, pool)
+                , m_function(std::forward<G>(f))
+                , m_group(group)
+            {
+            }
+
+        private:
+            using job_operation = executor_internals::job_operation;
+
+            //function to execute
+            std::optional<F> m_function;
+
+            //the group the job belongs to
+            task_group* const m_group;
+
+            //executes the function, unless the group is cancelled, then completes and deletes the job;
+            //the exception thrown by the function is stored in the group
+            static bool perform(job* j, job_operation op, std::exception_ptr* e) {
+                group_job* self = static_cast<group_job*>(j);
+                switch (op) {
+                    case job_operation::execute:
+                        if (!self->m_group->m_cancelled.load(std::memory_order_relaxed)) {
+                            (*self->m_function)();
+                        }
+                        break;
+
+                    case job_operation::fail:
+                        self->m_group->set_exception(std::move(*e));
+                        break;
+
+                    case job_operation::cancel:
+                        break;
+
+                    case job_operation::destroy:
+                        delete_job(self);
+                        return true;
+                }
+                self->complete();
+                delete_job(self);
+                return true;
+            }
+
+            //destroys the function and notifies the group
+            void complete() {
+                m_function.reset();
+                m_group->m_pending_job_count.decrement_and_notify_all();
+            }
+        };
+
+        //the executor of the jobs
+        executor& m_executor;
+
+        //cancellation flag; jobs of the group point to it
+        std::atomic<bool> m_cancelled{ false };
+
+        //number of jobs not yet completed or skipped
+        atomic_counter<size_t> m_pending_job_count;
+
+        //set when a job throws; the first thread to set it stores its exception
+        std::atomic<bool> m_failed{ false };
+
+        //the first exception thrown by a job; read after the jobs complete
+        std::exception_ptr m_exception;
+
+        //stores the first exception thrown by a job, and cancels the group
+        void set_exception(std::exception_ptr e) {
+            if (!m_failed.exchange(true, std::memory_order_acq_rel)) {
+                m_exception = std::move(e);
+            }
+            cancel();
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_TASK_GROUP_HPP
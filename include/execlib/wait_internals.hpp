@@ -0,0 +1,49 @@
+#ifndef EXECLIB_WAIT_INTERNALS_HPP
+#define EXECLIB_WAIT_INTERNALS_HPP
+
+
+#include <chrono>
+#include <thread>
+
+
+namespace execlib {
+
+
+    //internals of waiting while executing pending jobs
+    namespace wait_internals {
+
+
+        //number of times the thread yields before blocking
+        static constexpr unsigned YIELD_COUNT = 16;
+
+        //time blocked before checking for pending jobs again
+        static constexpr std::chrono::microseconds BLOCK_DURATION{ 500 };
+
+
+        //executes pending jobs of the executor until ready() returns true; when there are no pending jobs,
+        //the thread yields, then invokes block(BLOCK_DURATION), which blocks for at most that time
+        //unless ready() holds, checking again for pending jobs after each
+        template <class E, class Ready, class Block> void help_while_waiting(E& ex, Ready&& ready, Block&& block) {
+            unsigned idle_count = 0;
+            while (!ready()) {
+                if (ex.execute_pending_job()) {
+                    idle_count = 0;
+                }
+                else if (idle_count < YIELD_COUNT) {
+                    ++idle_count;
+                    std::this_thread::yield();
+                }
+                else {
+                    block(BLOCK_DURATION);
+                }
+            }
+        }
+
+
+    } //namespace wait_internals
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_WAIT_INTERNALS_HPP
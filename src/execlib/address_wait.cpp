@@ -0,0 +1,134 @@
+#include "execlib/address_wait.hpp"
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+
+namespace execlib {
+
+
+#if defined(__linux__)
+
+
+    //returns the address of the word, for the futex syscall
+    static uint32_t* futex_address(const std::atomic<uint32_t>& word) {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "std::atomic<uint32_t> must have the size of uint32_t");
+        return reinterpret_cast<uint32_t*>(const_cast<std::atomic<uint32_t>*>(&word));
+    }
+
+
+    //blocks on a futex
+    void wait_on_address(const std::atomic<uint32_t>& word, uint32_t value, std::chrono::nanoseconds timeout) {
+        timespec ts;
+        timespec* tsp = nullptr;
+        if (timeout != std::chrono::nanoseconds::max()) {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            ts.tv_sec = (time_t)seconds.count();
+            ts.tv_nsec = (long)(timeout - seconds).count();
+            tsp = &ts;
+        }
+        syscall(SYS_futex, futex_address(word), FUTEX_WAIT_PRIVATE, value, tsp, nullptr, 0);
+    }
+
+
+    //wakes up one thread blocked on a futex
+    void wake_by_address_one(const std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, futex_address(word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+
+
+    //wakes up all threads blocked on a futex
+    void wake_by_address_all(const std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, futex_address(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+
+#elif defined(_WIN32)
+
+
+    //blocks with WaitOnAddress
+    void wait_on_address(const std::atomic<uint32_t>& word, uint32_t value, std::chrono::nanoseconds timeout) {
+        DWORD milliseconds = INFINITE;
+        if (timeout != std::chrono::nanoseconds::max()) {
+            milliseconds = (DWORD)std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+        }
+        WaitOnAddress(const_cast<std::atomic<uint32_t>*>(&word), &value, sizeof(value), milliseconds);
+    }
+
+
+    //wakes up one thread blocked with WaitOnAddress
+    void wake_by_address_one(const std::atomic<uint32_t>& word) {
+        WakeByAddressSingle(const_cast<std::atomic<uint32_t>*>(&word));
+    }
+
+
+    //wakes up all threads blocked with WaitOnAddress
+    void wake_by_address_all(const std::atomic<uint32_t>& word) {
+        WakeByAddressAll(const_cast<std::atomic<uint32_t>*>(&word));
+    }
+
+
+#else
+
+
+    //a bucket of the wait table
+    struct alignas(64) wait_bucket {
+        std::mutex mutex;
+        std::condition_variable cond;
+    };
+
+
+    //returns the bucket of a word; words that share a bucket are woken up together
+    static wait_bucket& get_wait_bucket(const std::atomic<uint32_t>& word) {
+        static wait_bucket buckets[64];
+        return buckets[(reinterpret_cast<uintptr_t>(&word) >> 4) % 64];
+    }
+
+
+    //blocks on the condition variable of the word's bucket
+    void wait_on_address(const std::atomic<uint32_t>& word, uint32_t value, std::chrono::nanoseconds timeout) {
+        wait_bucket& bucket = get_wait_bucket(word);
+        std::unique_lock lock(bucket.mutex);
+        if (word.load(std::memory_order_acquire) != value) {
+            return;
+        }
+        if (timeout == std::chrono::nanoseconds::max()) {
+            bucket.cond.wait(lock);
+        }
+        else {
+            bucket.cond.wait_for(lock, timeout);
+        }
+    }
+
+
+    //the bucket is shared, therefore all threads are woken up
+    void wake_by_address_one(const std::atomic<uint32_t>& word) {
+        wake_by_address_all(word);
+    }
+
+
+    //wakes up all threads of the word's bucket
+    void wake_by_address_all(const std::atomic<uint32_t>& word) {
+        wait_bucket& bucket = get_wait_bucket(word);
+        {
+            std::lock_guard lock(bucket.mutex);
+        }
+        bucket.cond.notify_all();
+    }
+
+
+#endif
+
+
+} //namespace execlib
@@ -0,0 +1,28 @@
+#ifndef EXECLIB_CPU_PAUSE_HPP
+#define EXECLIB_CPU_PAUSE_HPP
+
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+
+namespace execlib {
+
+
+    //hints the cpu that the current thread is spinning
+    inline void cpu_pause() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_CPU_PAUSE_HPP
@@ -1,73 +1,206 @@
-#include <set>
+#include <vector>
+#include <thread>
 #include <algorithm>
-#include <memory_resource>
 #include "execlib/deadlock_free_mutex.hpp"
+#include "cpu_pause.hpp"
 
 
 namespace execlib {
 
 
-    using allocator = std::pmr::polymorphic_allocator<deadlock_free_mutex*>;
-    using locked_mutex_table = std::multiset<deadlock_free_mutex*, std::less<deadlock_free_mutex*>, allocator>;
+    //minimum number of spin iterations before unlocking the mutexes above a contended mutex
+    static constexpr unsigned MIN_SPIN_COUNT = 16;
 
+    //maximum number of spin iterations
+    static constexpr unsigned MAX_SPIN_COUNT = 1024;
 
-    //combines an unsynchronized memory pool and a table;
-    //allocation is thread-local and therefore there is no need
-    //for synchronization
-    struct local_thread_resources {
-        std::pmr::unsynchronized_pool_resource memory_pool;
-        locked_mutex_table table;
-        local_thread_resources() : table(allocator(&memory_pool)) {}
+    //number of consecutive failed relocks of a mutex after which a thread yields instead of spinning, 
+    //before unlocking and relocking again
+    static constexpr unsigned MAX_BACKOFF_SHIFT = 10;
+
+
+    //an entry of the locked mutex table
+    struct locked_mutex {
+        //the mutex
+        deadlock_free_mutex* mutex;
+
+        //number of times the thread has locked the mutex
+        size_t depth;
+    };
+
+
+    //the mutexes locked by a thread, sorted by address;
+    //it is a small inline array, which spills to the heap when it is full;
+    //it is thread-local and therefore there is no need for synchronization
+    class locked_mutex_table {
+    public:
+        //number of entries that do not require heap allocation
+        static constexpr size_t INLINE_CAPACITY = 16;
+
+        locked_mutex* begin() { return m_data; }
+        locked_mutex* end() { return m_data + m_size; }
+
+        //returns the entry of the mutex, or the entry it should be inserted before
+        locked_mutex* lower_bound(deadlock_free_mutex* mutex) {
+            //mutexes are usually locked in address order; then the mutex goes at the end
+            if (m_size == 0 || m_data[m_size - 1].mutex < mutex) {
+                return end();
+            }
+            return std::lower_bound(begin(), end(), mutex, [](const locked_mutex& e, deadlock_free_mutex* m) { return e.mutex < m; });
+        }
+
+        //inserts a mutex with depth 1 before the given position
+        void insert(locked_mutex* pos, deadlock_free_mutex* mutex) {
+            const size_t index = (size_t)(pos - m_data);
+            if (m_size == m_capacity) {
+                grow();
+            }
+            pos = m_data + index;
+            std::move_backward(pos, end(), end() + 1);
+            *pos = locked_mutex{ mutex, 1 };
+            ++m_size;
+        }
+
+        //inserts sorted mutexes that are not in the table, with depth 1, merging from the end
+        void insert(deadlock_free_mutex* const* first, deadlock_free_mutex* const* last) {
+            const size_t count = (size_t)(last - first);
+            while (m_size + count > m_capacity) {
+                grow();
+            }
+            locked_mutex* dst = m_data + m_size + count;
+            locked_mutex* src = end();
+            while (first != last) {
+                if (src != begin() && src[-1].mutex > last[-1]) {
+                    *--dst = *--src;
+                }
+                else {
+                    *--dst = locked_mutex{ *--last, 1 };
+                }
+            }
+            m_size += count;
+        }
+
+        //removes an entry
+        void erase(locked_mutex* pos) {
+            std::move(pos + 1, end(), pos);
+            --m_size;
+        }
+
+    private:
+        locked_mutex m_inline[INLINE_CAPACITY];
+        std::vector<locked_mutex> m_heap;
+        locked_mutex* m_data = m_inline;
+        size_t m_size = 0;
+        size_t m_capacity = INLINE_CAPACITY;
+
+        //doubles the capacity, moving the entries to the heap
+        void grow() {
+            if (m_data == m_inline) {
+                m_heap.assign(m_inline, m_inline + m_size);
+            }
+            m_capacity *= 2;
+            m_heap.resize(m_capacity);
+            m_data = m_heap.data();
+        }
     };
 
 
     //get the locked mutex table; safely initialized on first call
     static locked_mutex_table& get_locked_mutex_table() {
-        static thread_local local_thread_resources r;
-        return r.table;
+        static thread_local locked_mutex_table table;
+        return table;
+    }
+
+
+    //backs off exponentially before unlocking and relocking mutexes again, after consecutive failures
+    static void back_off(unsigned failure_count) {
+        if (failure_count > MAX_BACKOFF_SHIFT) {
+            std::this_thread::yield();
+            return;
+        }
+        for (unsigned i = 0, count = (1u << failure_count) - 1; i < count; ++i) {
+            cpu_pause();
+        }
+    }
+
+
+    //spins trying to lock the mutex; the spin count adapts to how long successful spins took;
+    //spinning is pointless with a single cpu
+    bool deadlock_free_mutex::spin_lock() {
+        static const bool multiprocessor = std::thread::hardware_concurrency() > 1;
+        if (!multiprocessor) {
+            return false;
+        }
+
+        const unsigned estimate = m_spin_estimate.load(std::memory_order_relaxed);
+        const unsigned max_count = std::min(MAX_SPIN_COUNT, estimate * 2 + MIN_SPIN_COUNT);
+        for (unsigned count = 1; count <= max_count; ++count) {
+            cpu_pause();
+            if (m_mutex.try_lock()) {
+                //move the estimate towards the spin count
+                m_spin_estimate.store((unsigned)((int)estimate + ((int)count - (int)estimate) / 8), std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        //the estimate decays, so as that mutexes held for long are not spun on
+        m_spin_estimate.store(estimate - estimate / 8, std::memory_order_relaxed);
+        return false;
     }
 
 
     //try to lock the mutex
     bool deadlock_free_mutex::try_lock() {
         auto& lmt = get_locked_mutex_table();
+        locked_mutex* const pos = lmt.lower_bound(this);
+
+        //already locked by this thread
+        if (pos != lmt.end() && pos->mutex == this) {
+            ++pos->depth;
+            return true;
+        }
 
         //if the mutex is successfully locked,
         //insert the mutex in the thread's locked mutex table
         //and return success
         if (m_mutex.try_lock()) {
-            lmt.insert(this);
+            reset_failed_relock_count();
+            m_lock_count.add();
+            lmt.insert(pos, this);
             return true;
         }
 
-        //failed to lock the mutex; perhaps there is a deadlock?
-        //unlock all mutexes above this and relock them
-
-        //insert the mutex into the locked mutex table in order to find
-        //all the mutexes above this mutex
-        const auto it = lmt.insert(this);
+        //no mutexes above this are locked, therefore there can be no deadlock to resolve
+        if (pos == lmt.end()) {
+            m_failed_try_lock_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
 
-        //unlock all mutexes above this
-        for (auto it1 = std::next(it); it1 != lmt.end(); ++it1) {
-            (*it1)->m_mutex.unlock();
+        //failed to lock the mutex; perhaps there is a deadlock?
+        //unlock all mutexes above this and relock them;
+        //if that keeps failing for this mutex, back off while they are unlocked, so as that other threads can lock them
+        for (locked_mutex* it = pos; it != lmt.end(); ++it) {
+            it->mutex->m_mutex.unlock();
         }
+        back_off(m_failed_relock_count.load(std::memory_order_relaxed));
 
-        //try relocking the mutex; if it fails, then relock all mutexes above this
-        //and remove this mutex from the locked mutex table
-        if (!m_mutex.try_lock()) {
-            for (auto it1 = std::next(it); it1 != lmt.end(); ++it1) {
-                (*it1)->m_mutex.lock();
-            }
-            lmt.erase(it);
-            return false;
+        //try relocking the mutex; then relock all mutexes above this
+        const bool locked = m_mutex.try_lock();
+        for (locked_mutex* it = pos; it != lmt.end(); ++it) {
+            it->mutex->m_mutex.lock();
         }
+        m_relock_count.fetch_add(1, std::memory_order_relaxed);
 
-        //lock all mutexes above this
-        for (auto it1 = std::next(it); it1 != lmt.end(); ++it1) {
-            (*it1)->m_mutex.lock();
+        if (!locked) {
+            m_failed_relock_count.fetch_add(1, std::memory_order_relaxed);
+            m_failed_try_lock_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
         }
 
-        //success
+        reset_failed_relock_count();
+        m_lock_count.add();
+        m_contended_lock_count.add();
+        lmt.insert(pos, this);
         return true;
     }
 
@@ -75,38 +208,162 @@ namespace execlib {
     //lock the mutex
     void deadlock_free_mutex::lock() {
         auto& lmt = get_locked_mutex_table();
+        locked_mutex* const pos = lmt.lower_bound(this);
+
+        //already locked by this thread
+        if (pos != lmt.end() && pos->mutex == this) {
+            ++pos->depth;
+            return;
+        }
 
         //if the mutex is successfully locked,
         //insert the mutex in the thread's locked mutex table
         //and return
         if (m_mutex.try_lock()) {
-            lmt.insert(this);
+            reset_failed_relock_count();
+            m_lock_count.add();
+            lmt.insert(pos, this);
             return;
         }
 
-        //failed to lock the mutex; perhaps there is a deadlock?
-        //unlock all mutexes above this and relock them
-
-        //insert the mutex into the locked mutex table in order to find
-        //all the mutexes above this mutex
-        const auto it = lmt.insert(this);
+        //the mutex is locked by another thread; it might be unlocked soon
+        if (spin_lock()) {
+            reset_failed_relock_count();
+            m_lock_count.add();
+            m_contended_lock_count.add();
+            m_spin_lock_count.add();
+            lmt.insert(pos, this);
+            return;
+        }
 
-        //unlock all mutexes above this
-        for (auto it1 = std::next(it); it1 != lmt.end(); ++it1) {
-            (*it1)->m_mutex.unlock();
+        //failed to lock the mutex; perhaps there is a deadlock?
+        //unlock all mutexes above this; if there are none, the thread blocks in address order
+        for (locked_mutex* it = pos; it != lmt.end(); ++it) {
+            it->mutex->m_mutex.unlock();
         }
 
-        //lock all mutexes from this and above this
-        for (auto it1 = it; it1 != lmt.end(); ++it1) {
-            (*it1)->m_mutex.lock();
+        //lock this and all mutexes above this, in address order
+        m_mutex.lock();
+        for (locked_mutex* it = pos; it != lmt.end(); ++it) {
+            it->mutex->m_mutex.lock();
+        }
+        if (pos != lmt.end()) {
+            m_relock_count.fetch_add(1, std::memory_order_relaxed);
         }
+
+        reset_failed_relock_count();
+        m_lock_count.add();
+        m_contended_lock_count.add();
+        lmt.insert(pos, this);
     }
 
 
     //unlock the mutex
     void deadlock_free_mutex::unlock() {
-        m_mutex.unlock();
-        get_locked_mutex_table().erase(this);
+        auto& lmt = get_locked_mutex_table();
+        locked_mutex* const pos = lmt.lower_bound(this);
+        if (--pos->depth == 0) {
+            lmt.erase(pos);
+            m_mutex.unlock();
+        }
+    }
+
+
+    //locks mutexes in address order
+    void deadlock_free_mutex::lock_all(deadlock_free_mutex** first, deadlock_free_mutex** last) {
+        auto& lmt = get_locked_mutex_table();
+        std::sort(first, last);
+
+        //duplicates are locked recursively, after the rest
+        std::vector<deadlock_free_mutex*> duplicates;
+        if (std::adjacent_find(first, last) != last) {
+            deadlock_free_mutex** unique_last = first;
+            for (deadlock_free_mutex** it = first + 1; it != last; ++it) {
+                if (*it == *unique_last) {
+                    duplicates.push_back(*it);
+                }
+                else {
+                    *++unique_last = *it;
+                }
+            }
+            last = unique_last + 1;
+        }
+
+        //mutexes already locked by this thread are removed from the list
+        last = std::remove_if(first, last, [&](deadlock_free_mutex* mutex) {
+            locked_mutex* const pos = lmt.lower_bound(mutex);
+            if (pos != lmt.end() && pos->mutex == mutex) {
+                ++pos->depth;
+                return true;
+            }
+            return false;
+        });
+
+        //lock the mutexes in address order, while they are not locked by other threads
+        deadlock_free_mutex** it = first;
+        for (; it != last; ++it) {
+            if ((*it)->m_mutex.try_lock()) {
+                (*it)->m_lock_count.add();
+            }
+            else if ((*it)->spin_lock()) {
+                (*it)->m_lock_count.add();
+                (*it)->m_contended_lock_count.add();
+                (*it)->m_spin_lock_count.add();
+            }
+            else {
+                break;
+            }
+        }
+
+        //a mutex is locked by another thread: unlock the mutexes above it, 
+        //then lock it, the rest of the list, and the unlocked mutexes, in address order
+        if (it != last) {
+            locked_mutex* const above = lmt.lower_bound(*it);
+            for (locked_mutex* e = above; e != lmt.end(); ++e) {
+                e->mutex->m_mutex.unlock();
+            }
+            if (above != lmt.end()) {
+                (*it)->m_relock_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            deadlock_free_mutex** m = it;
+            locked_mutex* e = above;
+            while (m != last || e != lmt.end()) {
+                if (e == lmt.end() || (m != last && *m < e->mutex)) {
+                    (*m++)->m_mutex.lock();
+                }
+                else {
+                    (e++)->mutex->m_mutex.lock();
+                }
+            }
+
+            (*it)->m_contended_lock_count.add();
+            for (m = it; m != last; ++m) {
+                (*m)->m_lock_count.add();
+            }
+        }
+
+        for (deadlock_free_mutex** m = first; m != last; ++m) {
+            (*m)->reset_failed_relock_count();
+        }
+
+        lmt.insert(first, last);
+
+        for (deadlock_free_mutex* mutex : duplicates) {
+            ++lmt.lower_bound(mutex)->depth;
+        }
+    }
+
+
+    //returns the contention statistics
+    deadlock_free_mutex_stats deadlock_free_mutex::stats() const {
+        deadlock_free_mutex_stats result;
+        result.lock_count = m_lock_count.get();
+        result.contended_lock_count = m_contended_lock_count.get();
+        result.spin_lock_count = m_spin_lock_count.get();
+        result.relock_count = m_relock_count.load(std::memory_order_relaxed);
+        result.failed_try_lock_count = m_failed_try_lock_count.load(std::memory_order_relaxed);
+        return result;
     }
 
 
@@ -0,0 +1,120 @@
+#ifndef EXECLIB_EVENTCOUNT_HPP
+#define EXECLIB_EVENTCOUNT_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace execlib {
+
+
+    //An eventcount: it allows threads to wait for a condition without locking,
+    //and notifiers to skip the notification, if there are no waiters.
+    //
+    //Waiter protocol:
+    //   key = ec.prepare_wait();
+    //   if (condition) ec.cancel_wait(); else ec.commit_wait(key);
+    //
+    //Notifier protocol:
+    //   make condition true; ec.notify_one();
+    class eventcount {
+    public:
+        //the key of a wait
+        using key = uint32_t;
+
+        //registers the current thread as a waiter; returns the key to wait on
+        key prepare_wait() {
+            const uint64_t state = m_state.fetch_add(1, std::memory_order_seq_cst);
+
+            //order the registration before the waiter reads its condition
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            return (key)(state >> EPOCH_SHIFT);
+        }
+
+        //unregisters the current thread as a waiter
+        void cancel_wait() {
+            m_state.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        //waits until a notification arrives after the given key was returned from prepare_wait,
+        //then unregisters the current thread as a waiter
+        void commit_wait(key k) {
+            {
+                std::unique_lock lock(m_mutex);
+                while ((key)(m_state.load(std::memory_order_acquire) >> EPOCH_SHIFT) == k) {
+                    m_cond.wait(lock);
+                }
+            }
+            cancel_wait();
+        }
+
+        //as commit_wait, but waits until the given time point;
+        //returns false if the time point was reached without a notification
+        template <class TimePoint> bool commit_wait_until(key k, const TimePoint& time_point) {
+            bool result = true;
+            {
+                std::unique_lock lock(m_mutex);
+                while ((key)(m_state.load(std::memory_order_acquire) >> EPOCH_SHIFT) == k) {
+                    if (m_cond.wait_until(lock, time_point) == std::cv_status::timeout) {
+                        result = (key)(m_state.load(std::memory_order_acquire) >> EPOCH_SHIFT) != k;
+                        break;
+                    }
+                }
+            }
+            cancel_wait();
+            return result;
+        }
+
+        //checks if there are waiters
+        bool has_waiters() const {
+            return (m_state.load(std::memory_order_seq_cst) & WAITER_MASK) != 0;
+        }
+
+        //wakes up one waiter; no system call is made if there are no waiters
+        void notify_one() {
+            if (advance_epoch()) {
+                m_cond.notify_one();
+            }
+        }
+
+        //wakes up all waiters; no system call is made if there are no waiters
+        void notify_all() {
+            if (advance_epoch()) {
+                m_cond.notify_all();
+            }
+        }
+
+    private:
+        //low bits: number of waiters; high bits: epoch
+        static constexpr unsigned EPOCH_SHIFT = 32;
+        static constexpr uint64_t WAITER_MASK = (uint64_t(1) << EPOCH_SHIFT) - 1;
+
+        //state
+        std::atomic<uint64_t> m_state{ 0 };
+
+        //for blocking waiters
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+
+        //if there are waiters, advances the epoch, synchronized with the waiters that are about to block
+        bool advance_epoch() {
+            //order the notifier's condition before reading the waiter count
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if ((m_state.load(std::memory_order_relaxed) & WAITER_MASK) == 0) {
+                return false;
+            }
+            m_state.fetch_add(uint64_t(1) << EPOCH_SHIFT, std::memory_order_release);
+            std::lock_guard lock(m_mutex);
+            return true;
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_EVENTCOUNT_HPP
@@ -1,9 +1,23 @@
 #include <stdexcept>
+#include <memory>
 #include <memory_resource>
 #include <deque>
+#include <numeric>
+#include <chrono>
 #include <condition_variable>
+#ifdef EXECLIB_TRACE
+#include <cstdio>
+#include <string>
+#include <ostream>
+#endif
 #include "execlib/executor.hpp"
 #include "executor_internals_private.hpp"
+#include "work_stealing_deque.hpp"
+#include "eventcount.hpp"
+#include "cpu_pause.hpp"
+#include "topology.hpp"
+#include "timing_wheel.hpp"
+#include "trace_buffer.hpp"
 
 
 namespace execlib {
@@ -12,6 +26,13 @@ namespace execlib {
     class _executor {
     public:
         using worker_thread = executor::worker_thread;
+        using producer = executor::producer;
+
+#ifdef EXECLIB_TRACE
+        //returns the trace buffer of the current thread for the given executor:
+        //the buffer of the current worker thread, or else of the current producer
+        static trace_buffer* current_trace_buffer(executor* ex);
+#endif
     };
 
 
@@ -23,333 +44,2024 @@ namespace execlib {
     static thread_local _executor::worker_thread* current_worker_thread = nullptr;
 
 
-    //queue definition
-    class executor::queue : private executor_internals::queue_base {
-    public:
-        //constructor.
-        queue(size_t index) 
-            : m_index(index)
-            , m_jobs(std::pmr::polymorphic_allocator<job*>(&m_memory_pool))
-        {
-        }
+    //the producer of the current thread for the executor it last put a job in, without owning a queue
+    static thread_local struct {
+        uint64_t executor_id = 0;
+        _executor::producer* producer = nullptr;
+    } current_producer;
+
+
+    //id of the next executor; ids start from 1, so as that no executor matches an empty producer cache
+    static std::atomic<uint64_t> next_executor_id{ 1 };
+
+
+    //returns the current time, in nanoseconds
+    static uint64_t now_ns() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
 
-        //returns the queue's mutex
-        std::mutex& get_mutex() { return m_mutex; }
 
-        //allocate memory for job; 
-        //unsynchronized because it is invoked from executor::execute
-        //which locks the queue's mutex separately;
-        //there is no corresponding free_memory_for_job function
-        //because the memory is freed from job::delete_this.
-        void* alloc_memory_for_job(size_t size) {
-            return m_memory_pool.allocate(size);
+    //statistics counter with a single writer thread; it is updated without read-modify-write operations,
+    //and it can be read from any thread
+    class stats_counter {
+    public:
+        //adds a value; it must only be invoked from the writer thread
+        void add(uint64_t value = 1) {
+            m_value.store(m_value.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
         }
 
-        //check if empty
-        bool empty() const {
-            return m_jobs.empty();
+        //adds a value with release semantics, for counters that are compared with counters of other threads;
+        //it must only be invoked from the writer thread
+        void add_release(uint64_t value = 1) {
+            m_value.store(m_value.load(std::memory_order_relaxed) + value, std::memory_order_release);
         }
 
-        //get job from queue
-        job* get_job() {
-            job* result = m_jobs.front();
-            m_jobs.pop_front();
-            return result;
+        //sets the value to the given one, if the given one is greater; it must only be invoked from the writer thread
+        void max(uint64_t value) {
+            if (value > m_value.load(std::memory_order_relaxed)) {
+                m_value.store(value, std::memory_order_relaxed);
+            }
         }
 
-        //put job in queue
-        void put_job(job* j) {
-            m_jobs.push_back(j);
+        //returns the value
+        uint64_t get() const {
+            return m_value.load(std::memory_order_relaxed);
         }
 
-        //notify the listener thread
-        void notify_listener() {
-            m_cond.notify_one();
+        //returns the value, with acquire semantics
+        uint64_t get_acquire() const {
+            return m_value.load(std::memory_order_acquire);
         }
 
     private:
-        //queue index
-        const size_t m_index;
+        std::atomic<uint64_t> m_value{ 0 };
+    };
 
-        //jobs; uses the unsynchronized memory pool 
-        //because synchronization is done on the queue's mutex
-        std::deque<job*, std::pmr::polymorphic_allocator<job*>> m_jobs;
 
-        //for thread notifications
-        std::condition_variable m_cond;
+    //number of times a thread that waits for the executor to become idle yields before sleeping
+    static constexpr size_t IDLE_WAIT_YIELD_COUNT = 16;
 
-        friend class executor;
-        friend class worker_thread;
+
+    //duration a thread that waits for the executor to become idle sleeps for, before checking again
+    static constexpr std::chrono::microseconds IDLE_WAIT_SLEEP_DURATION{ 500 };
+
+
+    //placement of a worker thread
+    struct worker_placement {
+        //the cpu the worker thread runs on; for threads that are not pinned, the assumed cpu
+        topology::cpu cpu;
+
+        //the cpus the worker thread is pinned to; empty if the thread is not pinned
+        std::vector<unsigned> cpu_ids;
     };
 
 
-    //worker thread
-    class executor::worker_thread {
+    //computes the placement of each worker thread, according to the affinity policy
+    static std::vector<worker_placement> make_placements(const executor_options& options) {
+        const topology& t = topology::get();
+        std::vector<worker_placement> result;
+
+        //threads are not pinned
+        if (options.affinity.policy == affinity_policy::none) {
+            for (size_t i = 0; i < options.thread_count; ++i) {
+                result.push_back(worker_placement{ t.cpu_for(i), {} });
+            }
+            return result;
+        }
+
+        //the distinct placements; threads wrap around them
+        std::vector<worker_placement> placements;
+
+        //one cpu per thread
+        if (options.affinity.policy == affinity_policy::cpu_list) {
+            if (options.affinity.cpus.empty()) {
+                throw std::invalid_argument("cpu list is empty");
+            }
+            for (const unsigned id : options.affinity.cpus) {
+                placements.push_back(worker_placement{ t.cpu_with_id(id), { id } });
+            }
+        }
+
+        //cpus grouped by core or by L3 cache
+        else {
+            const bool by_core = options.affinity.policy == affinity_policy::one_per_core;
+            for (const topology::cpu& c : t.cpus()) {
+                auto it = std::find_if(placements.begin(), placements.end(), [&](const worker_placement& p) {
+                    return by_core ? p.cpu.core == c.core : p.cpu.l3 == c.l3 && p.cpu.node == c.node;
+                });
+                if (it != placements.end()) {
+                    it->cpu_ids.push_back(c.id);
+                }
+                else {
+                    placements.push_back(worker_placement{ c, { c.id } });
+                }
+            }
+        }
+
+        for (size_t i = 0; i < options.thread_count; ++i) {
+            result.push_back(placements[i % placements.size()]);
+        }
+        return result;
+    }
+
+
+    //startup of the worker threads of an executor: each worker thread pins itself and creates its own queue,
+    //then waits until all queues are created; shared by the executor's constructor and the worker threads
+    class worker_startup {
     public:
-        //starts the worker thread
-        worker_thread(executor* ex, queue* q)
-            : m_executor(ex)
-            , m_queue(q)
-            , m_thread(&worker_thread::run, this)
-        {
+        //constructor
+        worker_startup(std::vector<worker_placement>&& placements) : m_placements(std::move(placements)) {}
+
+        //returns the placement of the worker thread with the given index
+        const worker_placement& placement(size_t index) const { return m_placements[index]; }
+
+        //invoked by a worker thread when its queue is created
+        void queue_created() {
+            std::lock_guard lock(m_mutex);
+            ++m_created_queue_count;
+            m_cond.notify_all();
         }
 
-        //stops the worker thread and waits for its termination
-        ~worker_thread() {
-            stop();
-            m_thread.join();
+        //waits until all queues are created
+        void wait_for_queues() {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [&]() { return m_created_queue_count == m_placements.size(); });
+        }
+
+        //lets the worker threads start executing jobs
+        void start() {
+            std::lock_guard lock(m_mutex);
+            m_started = true;
+            m_cond.notify_all();
+        }
+
+        //waits until the worker threads can start executing jobs
+        void wait_for_start() {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [&]() { return m_started; });
         }
 
     private:
-        //executor for this thread
-        executor* m_executor;
+        const std::vector<worker_placement> m_placements;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        size_t m_created_queue_count = 0;
+        bool m_started = false;
+    };
 
-        //the current queue
-        std::atomic<queue*> m_queue;
 
-        //stop flag
-        std::atomic<bool> m_stop{ false };
+    //number of job priorities
+    static constexpr size_t PRIORITY_COUNT = 3;
 
-        //condition variable to wait when suspended
-        std::condition_variable m_suspend_cond;
 
-        //the thread
-        std::thread m_thread;
+    //index of the background lane, which is stolen from only when no queue has jobs of higher priority
+    static constexpr size_t BACKGROUND_PRIORITY = (size_t)job_priority::background;
 
-        //stops this thread
-        void stop() {
-            m_stop.store(true, std::memory_order_release);
-            queue* q = m_queue.load(std::memory_order_acquire);
-            if (q) {
-                q->m_cond.notify_one();
+
+    //queue definition
+    class executor::queue : private executor_internals::queue_base {
+    public:
+        //constructor; it must be invoked from the owner thread, so as that the queue's memory
+        //is first touched on the owner thread's numa node
+        queue(size_t index, const worker_placement& placement) 
+            : m_index(index)
+            , m_placement(placement)
+            , m_lanes{ { &m_shared_pool.m_memory_pool }, { &m_shared_pool.m_memory_pool }, { &m_shared_pool.m_memory_pool } }
+        {
+            m_local_pool.m_memory_pool.reserve();
+            m_shared_pool.m_memory_pool.reserve();
+        }
+
+        //pins the current thread to the cpus of the queue, if the queue has cpus
+        void set_current_thread_affinity() const {
+            if (!m_placement.cpu_ids.empty()) {
+                topology::set_current_thread_affinity(m_placement.cpu_ids);
             }
-            m_suspend_cond.notify_one();
         }
 
-        //steal jobs from queue
-        bool steal_jobs(queue* dst, queue* src) {
-            //lock the queues
-            std::scoped_lock lock(src->m_mutex, dst->m_mutex);
+        //returns the queue's mutex
+        std::mutex& get_mutex() { return m_mutex; }
+
+        //get job from the owner's end of the lane with the given priority; lock-free;
+        //must be invoked from the owner thread
+        bool get_job(job*& j, size_t priority) {
+            return m_lanes[priority].jobs.pop(j);
+        }
 
-            //if the destination got some data while in the stealing phase, 
-            //return true to allow it to process that data
-            if (!dst->empty()) {
-                return true;
+        //get job from the lanes of the given priorities, highest priority first; lock-free;
+        //must be invoked from the owner thread
+        bool get_job(job*& j, size_t first_priority, size_t end_priority) {
+            for (size_t priority = first_priority; priority < end_priority; ++priority) {
+                if (get_job(j, priority)) {
+                    return true;
+                }
             }
+            return false;
+        }
 
-            //the source queue must have at least 2 jobs
-            if (src->m_jobs.size() < 2) {
-                return false;
+        //put job in the lane with the given priority; invoked with the queue's mutex locked;
+        //if the current thread is the owner of the queue, then the job is pushed
+        //to the lane's lock-free deque, otherwise it goes to the lane's inbox
+        void put_job(job* j, size_t priority);
+
+        //checks if the inbox of a lane has jobs, without locking
+        bool has_inbox_jobs(size_t priority) const {
+            return m_lanes[priority].inbox_size.load(std::memory_order_acquire) > 0;
+        }
+
+        //publishes the inbox size of a lane; invoked with the queue's mutex locked, after the inbox is modified
+        void update_inbox_size(size_t priority) {
+            lane& l = m_lanes[priority];
+            l.inbox_size.store(l.inbox.size(), std::memory_order_release);
+            m_stats.inbox_high_water_mark.max(l.inbox.size());
+        }
+
+        //updates the high water mark of the deques; must be invoked from the owner thread, after pushing jobs
+        void update_high_water_mark() {
+            size_t size = 0;
+            for (const lane& l : m_lanes) {
+                size += l.jobs.size();
             }
+            m_stats.high_water_mark.max(size);
+        }
 
-            //define the range of jobs to steal
-            auto begin = src->m_jobs.begin();
-            auto end = begin + src->m_jobs.size() / 2;
+        //returns the statistics of the queue
+        queue_stats get_stats() const {
+            queue_stats result;
+            result.stolen_from_job_count = (size_t)m_stats.stolen_from_job_count.load(std::memory_order_relaxed);
+            result.high_water_mark = (size_t)std::max(m_stats.high_water_mark.get(), m_stats.inbox_high_water_mark.get());
+            return result;
+        }
 
-            //insert jobs in destination
-            dst->m_jobs.insert(dst->m_jobs.end(), begin, end);
+        //move the jobs of the inbox of a lane to the lane's deque;
+        //must be invoked from the owner thread, with the queue's mutex locked
+        void take_inbox_jobs(size_t priority) {
+            lane& l = m_lanes[priority];
+            for (job* j : l.inbox) {
+                l.jobs.push(j);
+            }
+            l.inbox.clear();
+            update_inbox_size(priority);
+            update_high_water_mark();
+        }
 
-            //remove jobs from source
-            src->m_jobs.erase(begin, end);
+        //notify the listener thread; no system call is made if the listener thread is not parked
+        void notify_listener() {
+            m_eventcount.notify_one();
+        }
 
-            return true;
+        //checks if a released thread waits for the queue to be handed over to it
+        bool has_handover_request() const {
+            return m_handover_requested.load(std::memory_order_acquire);
         }
 
-        //steal jobs from executor
-        void steal_jobs(queue* q) {
-            for (size_t i = q->m_index + 1; i < m_executor->m_queues.size(); ++i) {
-                if (steal_jobs(q, m_executor->m_queues[i])) {
-                    return;
+        //returns the number of jobs put in the queue
+        uint64_t get_put_job_count() const {
+            return m_stats.put_job_count.get_acquire() + m_stats.inbox_put_job_count.get_acquire();
+        }
+
+        //destroys the pending jobs of the queue without executing them; returns their number;
+        //it must be invoked when no thread owns the queue
+        uint64_t discard_jobs() {
+            std::lock_guard lock(m_mutex);
+            uint64_t count = 0;
+            for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority) {
+                lane& l = m_lanes[priority];
+                for (job* j; l.jobs.pop(j); ++count) {
+                    discard_job(j);
                 }
+                for (job* j : l.inbox) {
+                    discard_job(j);
+                    ++count;
+                }
+                l.inbox.clear();
+                update_inbox_size(priority);
             }
-            for (size_t i = 0; i < q->m_index; ++i) {
-                if (steal_jobs(q, m_executor->m_queues[i])) {
-                    return;
+            return count;
+        }
+
+        //computes the victim groups of this queue; for the locality selection, queues are grouped
+        //by distance: same L3 cache, same numa node, rest; otherwise, all queues form one group
+        void init_victims(const std::vector<queue*>& queues, victim_selection selection) {
+            const topology::cpu& this_cpu = m_placement.cpu;
+            victim_group groups[3];
+
+            //for sequential selection, start from the next queue
+            for (size_t i = 1; i < queues.size(); ++i) {
+                queue* q = queues[(m_index + i) % queues.size()];
+                size_t distance = 0;
+                if (selection == victim_selection::locality) {
+                    const topology::cpu& victim_cpu = q->m_placement.cpu;
+                    distance = victim_cpu.l3 == this_cpu.l3 && victim_cpu.node == this_cpu.node ? 0 : victim_cpu.node == this_cpu.node ? 1 : 2;
+                }
+                groups[distance].queues.push_back(q);
+            }
+
+            //keep non-empty groups, computing the strides for random order;
+            //a stride coprime to the group size visits every queue once
+            for (victim_group& group : groups) {
+                if (group.queues.empty()) {
+                    continue;
+                }
+                for (size_t stride = 1; stride <= group.queues.size(); ++stride) {
+                    if (std::gcd(stride, group.queues.size()) == 1) {
+                        group.strides.push_back(stride);
+                    }
                 }
+                m_victims.push_back(std::move(group));
             }
         }
 
-        //runs the thread
-        void run() {
-            std::mutex suspend_mutex;
+    private:
+        //queue index
+        const size_t m_index;
 
-            current_executor = m_executor;
-            current_worker_thread = this;
+        //placement of the owner thread
+        const worker_placement m_placement;
 
-            //runs until stop is requested
-            for (;;) {
-                queue* q = m_queue.load(std::memory_order_acquire);
+        //jobs of one priority
+        struct lane {
+            //constructor
+            lane(std::pmr::memory_resource* inbox_memory) : inbox(std::pmr::polymorphic_allocator<job*>(inbox_memory)) {}
 
-                //if it has queue, then wait on jobs from queue
-                if (q) {
-                    job* j;
+            //jobs of the owner thread; lock-free; 
+            //pushed/popped by the owner thread, stolen by other threads
+            work_stealing_deque<job*> jobs;
 
-                    //synchronized on queue
-                    {
-                        std::unique_lock lock_queue(q->m_mutex);
+            //jobs put by other threads; uses the shared memory pool 
+            //because synchronization is done on the queue's mutex
+            std::deque<job*, std::pmr::polymorphic_allocator<job*>> inbox;
 
-                        //if no jobs, steal jobs from other queues
-                        if (q->m_jobs.empty()) {
-                            lock_queue.unlock();
-                            steal_jobs(q);
-                            lock_queue.lock();
-                        }
+            //size of inbox, readable without locking
+            std::atomic<size_t> inbox_size{ 0 };
+        };
 
-                        //wait while the queue is empty
-                        while (q->m_jobs.empty()) {
-                            //if stop was requested, return
-                            if (m_stop.load(std::memory_order_acquire)) {
-                                return;
-                            }
+        //lanes, highest priority first
+        lane m_lanes[PRIORITY_COUNT];
 
-                            //if suspended mode is entered, wait
-                            if (!m_queue.load(std::memory_order_acquire)) {
-                                goto SUSPEND;
-                            }
+        //for thread notifications; the owner thread parks on it
+        eventcount m_eventcount;
 
-                            //wait for jobs or stop/suspend event
-                            q->m_cond.wait(lock_queue);
-                        }
+        //group of victim queues for stealing
+        struct victim_group {
+            //the queues
+            std::vector<queue*> queues;
 
-                        //get job
-                        j = q->get_job();
-                    }
+            //strides that are coprime to the number of queues
+            std::vector<size_t> strides;
+        };
 
-                    //execute and delete job
-                    try {
-                        j->invoke();
-                    }
-                    catch (...) {
-                        j->delete_this();
-                        throw;
-                    }
-                    j->delete_this();
+        //victim queues, nearest group first
+        std::vector<victim_group> m_victims;
 
-                    //continue loop
-                    continue;
-                }
+        //destroys a job that is not executed, as if it was cancelled; embedded jobs are cancelled too,
+        //so as that their owners are notified, but their thunks do not release them
+        static void discard_job(job* j) {
+            j->perform(job_operation::cancel);
+        }
 
-                //suspend thread
-                SUSPEND:
+        //released threads that wait for the queue to be handed over to them, in request order;
+        //protected by the executor's worker thread mutex
+        std::vector<worker_thread*> m_handover_requests;
+
+        //set while there are handover requests, so as that the owner thread checks them without locking
+        std::atomic<bool> m_handover_requested{ false };
+
+        //statistics; on their own cache line, since they are written by other threads than the owner
+        struct alignas(64) stats_counters {
+            //jobs stolen by other threads; the only counter with many writers, updated once per steal
+            std::atomic<uint64_t> stolen_from_job_count{ 0 };
+
+            //high water mark of the deque; written by the owner thread
+            stats_counter high_water_mark;
+
+            //high water mark of the inbox; written with the queue's mutex locked
+            stats_counter inbox_high_water_mark;
+
+            //jobs pushed to the deques by the owner thread; counted before they are pushed,
+            //so as that the jobs executed never appear to be more than the jobs put
+            stats_counter put_job_count;
+
+            //jobs put to the inbox; written with the queue's mutex locked
+            stats_counter inbox_put_job_count;
+        } m_stats;
+
+        friend class executor;
+        friend class worker_thread;
+    };
 
-                //wait until a queue is set
-                do {
-                    //if stop was requested, return
-                    if (m_stop.load(std::memory_order_acquire)) {
-                        return;
-                    }
 
-                    //wait for event
-                    std::unique_lock suspend_lock(suspend_mutex);
-                    m_suspend_cond.wait(suspend_lock);
+    //producer definition.
+    //A thread that puts jobs in the executor without owning a queue allocates them from its own pool,
+    //without locking, and puts them in the queues of its cycle, in round-robin fashion, without sharing 
+    //a queue index with other threads; therefore only the queue the job is put in is locked.
+    class executor::producer {
+    public:
+        //constructor; the cycle starts from the given index
+        producer(std::thread::id thread_id, std::vector<queue*>&& queues, size_t first_queue_index)
+            : m_thread_id(thread_id)
+            , m_queues(std::move(queues))
+            , m_next_queue_index(first_queue_index % m_queues.size())
+        {
+        }
+
+        //returns the id of the thread of the producer
+        std::thread::id thread_id() const { return m_thread_id; }
 
-                } while (!m_queue.load(std::memory_order_acquire));
+        //returns the pool of the producer
+        job_pool* pool() { return &m_pool; }
+
+        //returns the next queue of the cycle; accessed only by the producer's thread
+        queue* next_queue() {
+            queue* q = m_queues[m_next_queue_index];
+            if (++m_next_queue_index == m_queues.size()) {
+                m_next_queue_index = 0;
             }
+            return q;
         }
 
+    private:
+        //the thread of the producer; a thread that reuses the id of a terminated thread reuses its producer
+        const std::thread::id m_thread_id;
+
+        //memory pool for the jobs of the producer; allocated from by the producer's thread,
+        //the executing threads return the memory via the pool's remote free list
+        alignas(64) job_pool m_pool;
+
+        //the queues the producer puts jobs in, in round-robin fashion
+        const std::vector<queue*> m_queues;
+
+        //index of the next queue in the cycle
+        size_t m_next_queue_index;
+
+#ifdef EXECLIB_TRACE
+        //buffer of the events recorded by the producer's thread
+        trace_buffer* m_trace_buffer = nullptr;
+#endif
+
         friend class executor;
+        friend class _executor;
     };
 
 
-    //The constructor.
-    executor::executor(size_t thread_count) {
-        //check thread count
-        if (thread_count == 0) {
-            throw std::invalid_argument("thread count is 0");
+#ifdef EXECLIB_TRACE
+    //trace buffers of an executor: one per worker thread and one per producer. The buffer of a deleted worker thread
+    //is reused by the next worker thread created, so as that creating and reaping released threads does not add buffers;
+    //buffers are deleted with the executor, therefore the events of terminated threads are kept.
+    class executor::trace_recorder {
+    public:
+        //constructor; it takes the time origin of the events
+        trace_recorder() : m_start_ticks(trace_clock_ticks()), m_start_time(std::chrono::steady_clock::now()) {}
+
+        trace_recorder(const trace_recorder&) = delete;
+        trace_recorder& operator = (const trace_recorder&) = delete;
+
+        //returns a buffer for a new worker thread
+        trace_buffer* acquire_worker_buffer() {
+            std::lock_guard lock(m_mutex);
+            if (!m_free_worker_buffers.empty()) {
+                trace_buffer* buffer = m_free_worker_buffers.back();
+                m_free_worker_buffers.pop_back();
+                return buffer;
+            }
+            return new_buffer("worker " + std::to_string(m_worker_buffer_count++));
         }
 
-        //create queues/threads
-        for (size_t i = 0; i < thread_count; ++i) {
-            queue* q = new queue(i);
-            m_queues.push_back(q);
+        //returns the buffer of a deleted worker thread
+        void release_worker_buffer(trace_buffer* buffer) {
+            std::lock_guard lock(m_mutex);
+            m_free_worker_buffers.push_back(buffer);
+        }
 
-            worker_thread* wt = new worker_thread(this, q);
-            m_worker_threads.push_back(wt);
+        //returns a buffer for a new producer
+        trace_buffer* new_producer_buffer() {
+            std::lock_guard lock(m_mutex);
+            return new_buffer("producer " + std::to_string(m_producer_buffer_count++));
         }
-    }
 
+        //writes the events in Chrome's trace event format; each buffer is a thread track.
+        //Jobs are slices, enqueueing is a zero-length slice that starts a flow to the job's slice, 
+        //and stealing is an instant event; ticks are converted to microseconds by the rate measured 
+        //since the recorder was created
+        void write(std::ostream& stream) const {
+            std::lock_guard lock(m_mutex);
+
+            const uint64_t elapsed_ticks = trace_clock_ticks() - m_start_ticks;
+            const double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_start_time).count();
+            const double us_per_tick = elapsed_ticks > 0 ? elapsed_us / (double)elapsed_ticks : 0;
+
+            std::vector<trace_buffer::event> events;
+            const char* separator = "";
+            char text[512];
+
+            //appends an event to the stream
+            auto write_event = [&](int length) {
+                stream << separator;
+                stream.write(text, std::min(length, (int)sizeof(text) - 1));
+                separator = ",\n";
+            };
+
+            stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+            for (size_t tid = 0; tid < m_buffers.size(); ++tid) {
+                const trace_buffer& buffer = *m_buffers[tid];
+                write_event(std::snprintf(text, sizeof(text), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}", tid, buffer.name().c_str()));
+
+                events.clear();
+                buffer.copy_events(events);
+
+                //finish events whose start was overwritten are skipped
+                size_t depth = 0;
+
+                for (const trace_buffer::event& e : events) {
+                    const double ts = (double)(int64_t)(e.ticks - m_start_ticks) * us_per_tick;
+                    const unsigned long long job = (unsigned long long)e.job;
+                    switch (e.type) {
+                        case trace_buffer::event_type::enqueue:
+                            write_event(std::snprintf(text, sizeof(text), "{\"name\":\"enqueue\",\"cat\":\"execlib\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":0.001,\"pid\":1,\"tid\":%zu,\"args\":{\"job\":\"0x%llx\",\"queue\":%u}}", ts, tid, job, e.queue_index));
+                            write_event(std::snprintf(text, sizeof(text), "{\"name\":\"job\",\"cat\":\"execlib\",\"ph\":\"s\",\"id\":\"0x%llx\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu}", job, ts, tid));
+                            break;
+
+                        case trace_buffer::event_type::steal:
+                            write_event(std::snprintf(text, sizeof(text), "{\"name\":\"steal\",\"cat\":\"execlib\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{\"job\":\"0x%llx\",\"queue\":%u}}", ts, tid, job, e.queue_index));
+                            break;
+
+                        case trace_buffer::event_type::start:
+                            if (e.queue_index != trace_buffer::NO_QUEUE) {
+                                write_event(std::snprintf(text, sizeof(text), "{\"name\":\"job\",\"cat\":\"execlib\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{\"job\":\"0x%llx\",\"queue\":%u}}", ts, tid, job, e.queue_index));
+                            }
+                            else {
+                                write_event(std::snprintf(text, sizeof(text), "{\"name\":\"job\",\"cat\":\"execlib\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{\"job\":\"0x%llx\"}}", ts, tid, job));
+                            }
+                            write_event(std::snprintf(text, sizeof(text), "{\"name\":\"job\",\"cat\":\"execlib\",\"ph\":\"f\",\"bp\":\"e\",\"id\":\"0x%llx\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu}", job, ts, tid));
+                            ++depth;
+                            break;
+
+                        case trace_buffer::event_type::finish:
+                            if (depth > 0) {
+                                write_event(std::snprintf(text, sizeof(text), "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%zu}", ts, tid));
+                                --depth;
+                            }
+                            break;
+                    }
+                }
+            }
+
+            stream << "\n]}\n";
+        }
 
-    //Signals all threads to stop execution, then waits for them to stop.
-    executor::~executor() {
-        //stop and delete worker threads
+    private:
+        //protects the buffer lists
+        mutable std::mutex m_mutex;
+
+        //all buffers
+        std::vector<std::unique_ptr<trace_buffer>> m_buffers;
+
+        //buffers of deleted worker threads
+        std::vector<trace_buffer*> m_free_worker_buffers;
+
+        //counts for buffer names
+        size_t m_worker_buffer_count = 0;
+        size_t m_producer_buffer_count = 0;
+
+        //time origin of the events
+        const uint64_t m_start_ticks;
+        const std::chrono::steady_clock::time_point m_start_time;
+
+        //creates a buffer
+        trace_buffer* new_buffer(std::string name) {
+            m_buffers.push_back(std::make_unique<trace_buffer>(std::move(name)));
+            return m_buffers.back().get();
+        }
+    };
+#endif
+
+
+    //timers of an executor; a timing wheel synchronized on a mutex.
+    //The first idle worker thread to park becomes the driver: it fires the expired timers, 
+    //then parks until the next timer, unless a job arrives, or an earlier timer is added.
+    class executor::timer_queue {
+    public:
+        //no tick
+        static constexpr uint64_t NO_TICK = UINT64_MAX;
+
+        //constructor
+        timer_queue(executor* ex)
+            : m_executor(ex)
+            , m_epoch(std::chrono::steady_clock::now())
         {
-            std::lock_guard lock(m_worker_thread_mutex);
-            for (worker_thread* wt : m_worker_threads) {
-                delete wt;
-            }
         }
 
-        //delete queues
-        for (queue* q : m_queues) {
-            delete q;
+        //deletes the tasks of pending timers
+        ~timer_queue() {
+            for (auto& block : m_blocks) {
+                for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                    delete block[i].task;
+                }
+            }
         }
-    }
 
+        //adds a timer
+        timer_handle add(timer_task* task, std::chrono::steady_clock::time_point time_point, std::chrono::steady_clock::duration period) {
+            queue* driver;
+            bool wake_up_driver;
+            timer_handle result;
+
+            {
+                std::lock_guard lock(m_mutex);
+                timer_node* node = new_node();
+                node->task = task;
+                node->period = period.count() > 0 ? std::max(tick_for(m_epoch + period), uint64_t(1)) : 0;
+                m_wheel.insert(node, tick_for(time_point));
+                update_next_tick();
+                result = timer_handle(node, node->generation);
+
+                //an earlier timer than the one the driver waits for, or no driver
+                driver = m_driver.load(std::memory_order_acquire);
+                wake_up_driver = node->tick < m_driver_tick;
+            }
 
-    //replace current worker thread with another thread
-    void executor::release_current_worker_thread() {
-        //check conditions
-        if (!current_worker_thread) {
-            throw std::logic_error("the current thread is not an executor worker thread");
+            if (driver) {
+                if (wake_up_driver) {
+                    driver->notify_listener();
+                }
+            }
+            else {
+                wake_up_idle_worker_thread(nullptr);
+            }
+
+            return result;
         }
 
-        //get the current queue
-        queue* current_worker_thread_queue = current_worker_thread->m_queue.load(std::memory_order_acquire);
+        //cancels a timer
+        bool cancel(const timer_handle& handle) {
+            timer_task* task;
+
+            {
+                std::lock_guard lock(m_mutex);
+                timer_node* node = static_cast<timer_node*>(handle.m_timer);
+                if (!node || node->generation != handle.m_generation) {
+                    return false;
+                }
+                m_wheel.remove(node);
+                task = node->task;
+                delete_node(node);
+                update_next_tick();
+            }
 
-        //make the current thread suspended by nullifying its queue pointer
-        current_worker_thread->m_queue.store(nullptr, std::memory_order_release);
+            delete task;
+            return true;
+        }
 
-        worker_thread* replacement_worker_thread;
+        //checks if there are pending timers, without locking
+        bool has_timers() const {
+            return m_next_tick.load(std::memory_order_acquire) != NO_TICK;
+        }
 
-        //lock the worker threads
-        std::lock_guard lock(current_executor->m_worker_thread_mutex);
+        //fires the expired timers, if there are any, and if no other thread fires them; for busy worker threads
+        void fire_due_timers() {
+            const uint64_t next_tick = m_next_tick.load(std::memory_order_acquire);
+            if (next_tick != NO_TICK && current_tick() >= next_tick) {
+                std::unique_lock lock(m_mutex, std::try_to_lock);
+                if (lock.owns_lock()) {
+                    fire_expired_timers(lock);
+                }
+            }
+        }
 
-        //if there is a released worker thread, use that
-        if (!current_executor->m_released_worker_threads.empty()) {
-            replacement_worker_thread = current_executor->m_released_worker_threads.back();
-            current_executor->m_released_worker_threads.pop_back();
-            replacement_worker_thread->m_queue.store(current_worker_thread_queue, std::memory_order_release);
-            replacement_worker_thread->m_suspend_cond.notify_one();
+        //makes the given queue's owner thread the driver, if there is no driver and there are timers
+        bool start_driving(queue* q) {
+            queue* expected = nullptr;
+            return has_timers() && m_driver.compare_exchange_strong(expected, q, std::memory_order_acq_rel);
         }
 
-        //else create new worker thread
-        else {
-            replacement_worker_thread = new worker_thread(current_executor, current_worker_thread_queue);
-            current_executor->m_worker_threads.push_back(replacement_worker_thread);
+        //fires the expired timers, then returns the time point of the next work for the driver
+        std::chrono::steady_clock::time_point drive() {
+            std::unique_lock lock(m_mutex);
+            fire_expired_timers(lock);
+            lock.lock();
+            m_driver_tick = m_wheel.size() > 0 ? m_wheel.next_tick() : NO_TICK;
+            return m_driver_tick != NO_TICK ? time_point_for(m_driver_tick) : std::chrono::steady_clock::time_point::max();
         }
 
-        //add the current thread to the released ones
-        current_executor->m_released_worker_threads.push_back(current_worker_thread);
-    }
+        //the driver stops driving; if there are timers, another idle worker thread becomes the driver
+        void stop_driving(queue* q) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_driver_tick = NO_TICK;
+                m_driver.store(nullptr, std::memory_order_release);
+            }
+            if (has_timers()) {
+                wake_up_idle_worker_thread(q);
+            }
+        }
 
+    private:
+        //timer node
+        struct timer_node : timing_wheel::node {
+            //the task; null for free nodes
+            timer_task* task = nullptr;
 
-    //get current thread executor
-    executor* executor::get_current_executor() {
-        return current_executor;
-    }
+            //period, in ticks; 0 for one-shot timers
+            uint64_t period = 0;
 
+            //incremented when the node is freed, so as that stale handles do not match the node
+            uint64_t generation = 0;
 
-    //get mutex of queue
-    std::mutex& executor::get_mutex(queue* q) {
-        return q->get_mutex();
-    }
+            //next free node
+            timer_node* next_free = nullptr;
+        };
 
+        //nodes are allocated in blocks, which are freed when the executor is destroyed,
+        //so as that handles of expired timers can be safely compared to nodes
+        static constexpr size_t BLOCK_SIZE = 256;
 
-    //allocate memory from queue
-    void* executor::alloc_memory_for_job(queue* q, size_t size) {
-        return q->alloc_memory_for_job(size);
-    }
+        //the executor
+        executor* const m_executor;
 
+        //time of tick 0
+        const std::chrono::steady_clock::time_point m_epoch;
 
-    //put job in queue
-    void executor::put_job(queue* q, job* j) {
-        q->put_job(j);
-    }
+        //protects the wheel, the nodes, and the driver tick
+        std::mutex m_mutex;
 
+        //pending timers
+        timing_wheel m_wheel;
 
-    //notifies the queue listener that a new job is available
-    void executor::notify_listener(queue* q) {
-        q->notify_listener();
+        //blocks of nodes
+        std::vector<std::unique_ptr<timer_node[]>> m_blocks;
+
+        //free nodes
+        timer_node* m_free_nodes = nullptr;
+
+        //next tick that has work, or NO_TICK if there are no timers; readable without locking
+        std::atomic<uint64_t> m_next_tick{ NO_TICK };
+
+        //queue of the driver thread, or null
+        std::atomic<queue*> m_driver{ nullptr };
+
+        //tick the driver waits for
+        uint64_t m_driver_tick = NO_TICK;
+
+        //returns the tick of a time point, rounded up, so as that timers do not expire early
+        uint64_t tick_for(std::chrono::steady_clock::time_point time_point) const {
+            if (time_point <= m_epoch) {
+                return 0;
+            }
+            const auto ticks = std::chrono::ceil<std::chrono::milliseconds>(time_point - m_epoch).count();
+            return (uint64_t)ticks;
+        }
+
+        //returns the time point of a tick
+        std::chrono::steady_clock::time_point time_point_for(uint64_t tick) const {
+            return m_epoch + std::chrono::milliseconds(tick);
+        }
+
+        //returns the current tick, rounded down
+        uint64_t current_tick() const {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        //publishes the next tick; invoked with the mutex locked
+        void update_next_tick() {
+            m_next_tick.store(m_wheel.size() > 0 ? m_wheel.next_tick() : NO_TICK, std::memory_order_release);
+        }
+
+        //allocates a node; invoked with the mutex locked
+        timer_node* new_node() {
+            if (!m_free_nodes) {
+                m_blocks.emplace_back(new timer_node[BLOCK_SIZE]);
+                for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                    m_blocks.back()[i].next_free = m_free_nodes;
+                    m_free_nodes = &m_blocks.back()[i];
+                }
+            }
+            timer_node* node = m_free_nodes;
+            m_free_nodes = node->next_free;
+            return node;
+        }
+
+        //frees a node; invoked with the mutex locked
+        void delete_node(timer_node* node) {
+            node->task = nullptr;
+            ++node->generation;
+            node->next_free = m_free_nodes;
+            m_free_nodes = node;
+        }
+
+        //fires the expired timers; invoked with the mutex locked, which is unlocked on return;
+        //jobs of periodic timers are put while the mutex is locked, since a concurrent cancel would delete the task;
+        //jobs of one-shot timers are put after the mutex is unlocked
+        void fire_expired_timers(std::unique_lock<std::mutex>& lock) {
+            const uint64_t now = current_tick();
+            std::vector<timer_task*> expired_tasks;
+
+            m_wheel.advance(now, [&](timing_wheel::node* n) {
+                timer_node* node = static_cast<timer_node*>(n);
+
+                //one-shot timer
+                if (node->period == 0) {
+                    expired_tasks.push_back(node->task);
+                    delete_node(node);
+                    return;
+                }
+
+                //periodic timer; missed periods are skipped
+                node->task->schedule(m_executor);
+                uint64_t next = node->tick + node->period;
+                if (next <= now) {
+                    next += ((now - next) / node->period + 1) * node->period;
+                }
+                m_wheel.insert(node, next);
+            });
+
+            update_next_tick();
+            lock.unlock();
+
+            for (timer_task* task : expired_tasks) {
+                task->schedule(m_executor);
+                delete task;
+            }
+        }
+
+        //wakes up an idle worker thread, other than the owner of the given queue, so as that it becomes the driver
+        void wake_up_idle_worker_thread(queue* except) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_executor->m_idle_worker_thread_count.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            for (queue* q : m_executor->m_queues) {
+                if (q != except && q->m_eventcount.has_waiters()) {
+                    q->notify_listener();
+                    return;
+                }
+            }
+        }
+    };
+
+
+    //worker thread
+    class executor::worker_thread {
+    public:
+        //starts the worker thread for an existing queue
+        worker_thread(executor* ex, queue* q)
+            : m_executor(ex)
+            , m_queue(q)
+            , m_random_state(0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)this)
+            , m_thread(&worker_thread::run, this)
+        {
+        }
+
+        //starts the worker thread; the thread creates the queue with the given index
+        worker_thread(executor* ex, size_t queue_index, std::shared_ptr<worker_startup> startup)
+            : m_executor(ex)
+            , m_queue(nullptr)
+            , m_random_state(0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)this)
+            , m_thread(&worker_thread::start, this, queue_index, std::move(startup))
+        {
+        }
+
+        //stops the worker thread and waits for its termination, unless it is already joined
+        ~worker_thread() {
+            if (m_thread.joinable()) {
+                join();
+            }
+#ifdef EXECLIB_TRACE
+            m_executor->m_trace_recorder->release_worker_buffer(m_trace_buffer);
+#endif
+        }
+
+    private:
+        //executor for this thread
+        executor* m_executor;
+
+        //the current queue
+        std::atomic<queue*> m_queue;
+
+        //stop flag
+        std::atomic<bool> m_stop{ false };
+
+        //condition variable to wait when suspended, or for a queue to be handed over;
+        //used with the executor's worker thread mutex
+        std::condition_variable m_suspend_cond;
+
+        //state for random victim selection; accessed only by this thread
+        uint64_t m_random_state;
+
+        //statistics; written only by this thread, read by executor::stats()
+        struct alignas(64) stats_counters {
+            stats_counter executed_job_count;
+            stats_counter stolen_job_count;
+            stats_counter failed_steal_count;
+            stats_counter park_count;
+            stats_counter unpark_count;
+            stats_counter parked_time;
+            stats_counter busy_time;
+        } m_stats;
+
+        //start of the current busy period
+        uint64_t m_busy_start = now_ns();
+
+        //the queue whose cpus this thread is pinned to; accessed only by this thread
+        queue* m_pinned_queue = nullptr;
+
+        //the queue this thread released, while it executes the job that released it;
+        //protected by the executor's worker thread mutex
+        queue* m_released_queue = nullptr;
+
+#ifdef EXECLIB_TRACE
+        //buffer of the events recorded by this thread
+        trace_buffer* const m_trace_buffer = m_executor->m_trace_recorder->acquire_worker_buffer();
+#endif
+
+        //the thread
+        std::thread m_thread;
+
+        //stops this thread; the flag is set with the worker thread mutex locked, 
+        //so as that a suspended thread either sees it or is waiting when notified
+        void stop() {
+            {
+                std::lock_guard lock(m_executor->m_worker_thread_mutex);
+                m_stop.store(true, std::memory_order_seq_cst);
+            }
+            queue* q = m_queue.load(std::memory_order_acquire);
+            if (q) {
+                q->m_eventcount.notify_all();
+            }
+            m_suspend_cond.notify_one();
+        }
+
+        //stops this thread and waits for its termination
+        void join() {
+            stop();
+            m_thread.join();
+        }
+
+        //steal jobs from a lane of a queue; the current thread is the owner of the destination queue,
+        //therefore the stolen jobs are pushed directly to the destination's lane deque of the same priority
+        bool steal_jobs(queue* dst, queue* src, size_t priority) {
+            queue::lane& src_lane = src->m_lanes[priority];
+            queue::lane& dst_lane = dst->m_lanes[priority];
+
+            //steal up to half the jobs from the top of the source deque, lock-free
+            const size_t count = (src_lane.jobs.size() + 1) / 2;
+            size_t stolen = 0;
+            for (job* j; stolen < count && src_lane.jobs.steal(j); ++stolen) {
+                EXECLIB_TRACE_EVENT(m_trace_buffer, steal, j, src->m_index);
+                dst_lane.jobs.push(j);
+            }
+            if (stolen > 0) {
+                record_steal(dst, src, stolen);
+                return true;
+            }
+
+            //if the source deque is empty, then jobs might be waiting in the source inbox,
+            //if the owner thread of the source is busy
+            if (!src->has_inbox_jobs(priority)) {
+                return false;
+            }
+            std::lock_guard lock_src(src->m_mutex);
+
+            //the source inbox must have at least 2 jobs, since its owner thread is notified for them
+            if (src_lane.inbox.size() < 2) {
+                return false;
+            }
+
+            //define the range of jobs to steal
+            auto begin = src_lane.inbox.begin();
+            auto end = begin + src_lane.inbox.size() / 2;
+
+            //insert jobs in destination
+            for (auto it = begin; it != end; ++it) {
+                EXECLIB_TRACE_EVENT(m_trace_buffer, steal, *it, src->m_index);
+                dst_lane.jobs.push(*it);
+            }
+
+            //remove jobs from source
+            record_steal(dst, src, (size_t)(end - begin));
+            src_lane.inbox.erase(begin, end);
+            src->update_inbox_size(priority);
+
+            return true;
+        }
+
+        //updates the statistics for jobs stolen from the source queue to the destination queue
+        void record_steal(queue* dst, queue* src, size_t count) {
+            m_stats.stolen_job_count.add(count);
+            src->m_stats.stolen_from_job_count.fetch_add(count, std::memory_order_relaxed);
+            dst->update_high_water_mark();
+        }
+
+        //steal jobs of the given priorities from executor; victim groups are tried nearest first, 
+        //in sequential or random order, for the number of rounds of the steal policy;
+        //the lanes of each victim are tried highest priority first
+        bool steal_jobs(queue* q, size_t first_priority, size_t end_priority) {
+            const steal_policy& policy = m_executor->m_options.steal;
+            const bool randomize = policy.victims != victim_selection::sequential;
+            const size_t round_count = std::max(policy.round_count, size_t(1));
+
+            for (size_t round = 0; round < round_count; ++round) {
+                for (const queue::victim_group& group : q->m_victims) {
+                    const size_t count = group.queues.size();
+                    size_t index = 0;
+                    size_t stride = 1;
+
+                    //random start and random stride
+                    if (randomize) {
+                        const uint64_t r = next_random();
+                        index = (size_t)(r % count);
+                        stride = group.strides[(size_t)((r >> 32) % group.strides.size())];
+                    }
+
+                    for (size_t i = 0; i < count; ++i, index = (index + stride) % count) {
+                        for (size_t priority = first_priority; priority < end_priority; ++priority) {
+                            if (steal_jobs(q, group.queues[index], priority)) {
+                                return true;
+                            }
+                        }
+                    }
+                }
+                cpu_pause();
+            }
+
+            return false;
+        }
+
+        //returns the next pseudo-random number (xorshift64*)
+        uint64_t next_random() {
+            m_random_state ^= m_random_state >> 12;
+            m_random_state ^= m_random_state << 25;
+            m_random_state ^= m_random_state >> 27;
+            return m_random_state * 0x2545F4914F6CDD1DULL;
+        }
+
+        //executes and releases the job, with one call to its thunk; embedded jobs are not released, 
+        //and they are not accessed after being invoked; an exception is stored in the job's future or task group, 
+        //or passed to the executor's exception handler
+        static void execute_job(executor* ex, job* j) {
+            const bool embedded = j->is_embedded();
+            try {
+                j->perform(job_operation::execute);
+            }
+            catch (...) {
+                std::exception_ptr e = std::current_exception();
+                if (embedded || !j->perform(job_operation::fail, &e)) {
+                    ex->handle_exception(std::move(e));
+                }
+            }
+        }
+
+        //steal one job from any queue of the executor, for threads that do not own a queue;
+        //priorities are tried highest first, and the queues are tried starting from the given index
+        static bool steal_job(executor* ex, size_t first_queue_index, job*& j) {
+            const size_t queue_count = ex->m_queues.size();
+
+            for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority) {
+                //try the deques first, lock-free
+                for (size_t i = 0; i < queue_count; ++i) {
+                    queue* q = ex->m_queues[(first_queue_index + i) % queue_count];
+                    if (q->m_lanes[priority].jobs.steal(j)) {
+                        q->m_stats.stolen_from_job_count.fetch_add(1, std::memory_order_relaxed);
+                        EXECLIB_TRACE_EVENT(_executor::current_trace_buffer(ex), steal, j, q->m_index);
+                        return true;
+                    }
+                }
+
+                //then try the inboxes
+                for (size_t i = 0; i < queue_count; ++i) {
+                    queue* q = ex->m_queues[(first_queue_index + i) % queue_count];
+                    if (!q->has_inbox_jobs(priority)) {
+                        continue;
+                    }
+                    std::lock_guard lock_queue(q->m_mutex);
+                    queue::lane& l = q->m_lanes[priority];
+                    if (!l.inbox.empty()) {
+                        q->m_stats.stolen_from_job_count.fetch_add(1, std::memory_order_relaxed);
+                        j = l.inbox.front();
+                        l.inbox.pop_front();
+                        q->update_inbox_size(priority);
+                        EXECLIB_TRACE_EVENT(_executor::current_trace_buffer(ex), steal, j, q->m_index);
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        //checks if the thread should keep processing the given queue
+        bool is_active(queue* q) const {
+            return !m_stop.load(std::memory_order_seq_cst) && m_queue.load(std::memory_order_acquire) == q && !q->has_handover_request();
+        }
+
+        //finds a job of the given priority in the given queue: from the lane's deque, then from the lane's inbox
+        static bool find_local_job(queue* q, job*& j, size_t priority) {
+            if (q->get_job(j, priority)) {
+                return true;
+            }
+
+            //move the jobs of other threads to the deque
+            if (q->has_inbox_jobs(priority)) {
+                std::lock_guard lock_queue(q->m_mutex);
+                q->take_inbox_jobs(priority);
+                return q->get_job(j, priority);
+            }
+
+            return false;
+        }
+
+        //finds a job for the given queue: high and normal priority jobs of the queue, then by stealing them,
+        //then background jobs of the queue, then by stealing them
+        bool find_job(queue* q, job*& j) {
+            for (size_t priority = 0; priority < BACKGROUND_PRIORITY; ++priority) {
+                if (find_local_job(q, j, priority)) {
+                    return true;
+                }
+            }
+
+            //steal high and normal priority jobs from other queues
+            if (steal_jobs(q, size_t(0), BACKGROUND_PRIORITY)) {
+                return q->get_job(j, size_t(0), PRIORITY_COUNT);
+            }
+
+            //background jobs
+            if (find_local_job(q, j, BACKGROUND_PRIORITY)) {
+                return true;
+            }
+            if (steal_jobs(q, BACKGROUND_PRIORITY, PRIORITY_COUNT)) {
+                return q->get_job(j, size_t(0), PRIORITY_COUNT);
+            }
+
+            m_stats.failed_steal_count.add();
+            return false;
+        }
+
+        //waits for a job, according to the idle policy; the end of the busy period is recorded, 
+        //and a new busy period starts when a job is found
+        bool wait_for_job(queue* q, job*& j) {
+            const uint64_t idle_start = now_ns();
+            m_stats.busy_time.add(idle_start - m_busy_start);
+            const bool result = spin_park_for_job(q, j);
+            m_busy_start = now_ns();
+            return result;
+        }
+
+        //waits for a job: spins, then yields, then parks;
+        //returns false if the thread is stopped or suspended
+        bool spin_park_for_job(queue* q, job*& j) {
+            const idle_policy& policy = m_executor->m_options.idle;
+
+            //spin, with pause instructions
+            for (size_t i = 0; i < policy.spin_count && is_active(q); ++i) {
+                cpu_pause();
+                if (find_job(q, j)) {
+                    return true;
+                }
+            }
+
+            //yield to other threads
+            for (size_t i = 0; i < policy.yield_count && is_active(q); ++i) {
+                std::this_thread::yield();
+                if (find_job(q, j)) {
+                    return true;
+                }
+            }
+
+            //park
+            for (;;) {
+                const eventcount::key key = q->m_eventcount.prepare_wait();
+                m_executor->m_idle_worker_thread_count.fetch_add(1, std::memory_order_seq_cst);
+
+                //stop or suspend
+                if (!is_active(q)) {
+                    m_executor->m_idle_worker_thread_count.fetch_sub(1, std::memory_order_relaxed);
+                    q->m_eventcount.cancel_wait();
+                    return false;
+                }
+
+                //a job arrived while preparing to wait
+                if (find_job(q, j)) {
+                    m_executor->m_idle_worker_thread_count.fetch_sub(1, std::memory_order_relaxed);
+                    q->m_eventcount.cancel_wait();
+                    return true;
+                }
+
+                //the first idle thread drives the timers: it fires the expired timers, 
+                //then waits until the next timer, unless a job arrives
+                timer_queue& timers = *m_executor->m_timers;
+                const bool driving = timers.start_driving(q);
+                const std::chrono::steady_clock::time_point wake_up_time = driving ? timers.drive() : std::chrono::steady_clock::time_point::max();
+
+                //jobs of the expired timers
+                if (driving && find_job(q, j)) {
+                    timers.stop_driving(q);
+                    m_executor->m_idle_worker_thread_count.fetch_sub(1, std::memory_order_relaxed);
+                    q->m_eventcount.cancel_wait();
+                    return true;
+                }
+
+                //wait for jobs or stop/suspend event, or for jobs to steal, or for the next timer
+                m_stats.park_count.add();
+                const uint64_t park_start = now_ns();
+                if (wake_up_time != std::chrono::steady_clock::time_point::max()) {
+                    q->m_eventcount.commit_wait_until(key, wake_up_time);
+                }
+                else {
+                    q->m_eventcount.commit_wait(key);
+                }
+                m_stats.parked_time.add(now_ns() - park_start);
+                m_stats.unpark_count.add();
+                if (driving) {
+                    timers.stop_driving(q);
+                }
+                m_executor->m_idle_worker_thread_count.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        //pins the thread, creates its queue, waits for the other threads to create their queues, then runs
+        void start(size_t queue_index, std::shared_ptr<worker_startup> startup) {
+            const worker_placement& placement = startup->placement(queue_index);
+
+            //pin the thread before creating the queue, so as that the queue's memory is allocated on its numa node
+            if (!placement.cpu_ids.empty()) {
+                topology::set_current_thread_affinity(placement.cpu_ids);
+            }
+            queue* q = new queue(queue_index, placement);
+            m_pinned_queue = q;
+
+            //publish the queue
+            m_executor->m_queues[queue_index] = q;
+            m_queue.store(q, std::memory_order_release);
+            startup->queue_created();
+
+            //the victims of all queues are computed before jobs are executed
+            startup->wait_for_start();
+            startup.reset();
+
+            run();
+        }
+
+        //runs the thread
+        void run() {
+            current_executor = m_executor;
+            current_worker_thread = this;
+
+            //runs until stop is requested; the remaining jobs are not executed
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                queue* q = m_queue.load(std::memory_order_acquire);
+
+                //jobs of the queue's local pool are allocated and deallocated by this thread
+                current_local_pool = q ? &q->m_local_pool : nullptr;
+
+                //a thread that takes over a queue runs on the queue's cpus
+                if (q && q != m_pinned_queue) {
+                    q->set_current_thread_affinity();
+                    m_pinned_queue = q;
+                }
+
+                //if it has queue, then wait on jobs from queue
+                if (q) {
+                    job* j;
+
+                    //get a job, or wait for one
+                    if (find_job(q, j) || wait_for_job(q, j)) {
+                        //execute and release job
+                        EXECLIB_TRACE_EVENT(m_trace_buffer, start, j, q->m_index);
+                        execute_job(m_executor, j);
+                        EXECLIB_TRACE_EVENT(m_trace_buffer, finish, j, q->m_index);
+                        m_stats.executed_job_count.add_release();
+
+                        //fire the timers that expired while the job was executing
+                        m_executor->m_timers->fire_due_timers();
+
+                        //a released thread wants its queue back
+                        if (q->has_handover_request()) {
+                            hand_over_queue(q);
+                        }
+
+                        //continue loop
+                        continue;
+                    }
+
+                    //if stop was requested, return
+                    if (m_stop.load(std::memory_order_acquire)) {
+                        return;
+                    }
+
+                    //a released thread wants its queue back
+                    if (q->has_handover_request()) {
+                        hand_over_queue(q);
+                    }
+
+                    //suspended mode is entered
+                    continue;
+                }
+
+                //suspend thread; wait until a queue is set, or terminate after the idle timeout
+                if (!suspend()) {
+                    return;
+                }
+
+                //the suspended period is not busy
+                m_busy_start = now_ns();
+            }
+        }
+
+        //waits for a queue, as an idle released thread; returns false if the thread must terminate,
+        //either because it is stopped, or because the idle timeout expired
+        bool suspend() {
+            std::unique_lock lock(m_executor->m_worker_thread_mutex);
+
+            //the job that released the thread is over
+            m_released_queue = nullptr;
+            if (m_stop.load(std::memory_order_acquire)) {
+                return false;
+            }
+            m_executor->m_released_worker_threads.push_back(this);
+
+            const auto deadline = std::chrono::steady_clock::now() + m_executor->m_options.release.idle_timeout;
+            while (!m_queue.load(std::memory_order_acquire)) {
+                if (m_stop.load(std::memory_order_acquire)) {
+                    return false;
+                }
+
+                //terminate after the timeout; the thread is joined and deleted later, by another thread
+                if (m_suspend_cond.wait_until(lock, deadline) == std::cv_status::timeout && !m_queue.load(std::memory_order_acquire) && !m_stop.load(std::memory_order_acquire)) {
+                    erase_worker_thread(m_executor->m_released_worker_threads, this);
+                    erase_worker_thread(m_executor->m_worker_threads, this);
+                    m_executor->m_exited_worker_threads.push_back(this);
+                    m_executor->m_exited_executed_job_count += m_stats.executed_job_count.get();
+                    ++m_executor->m_reaped_worker_thread_count;
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        //hands the queue over to the first released thread that requested it; this thread becomes released
+        void hand_over_queue(queue* q) {
+            std::lock_guard lock(m_executor->m_worker_thread_mutex);
+            if (q->m_handover_requests.empty()) {
+                return;
+            }
+            worker_thread* requester = q->m_handover_requests.front();
+            q->m_handover_requests.erase(q->m_handover_requests.begin());
+            q->m_handover_requested.store(!q->m_handover_requests.empty(), std::memory_order_release);
+
+            //this thread no longer runs on the queue's cpus
+            m_queue.store(nullptr, std::memory_order_release);
+            current_local_pool = nullptr;
+            unpin();
+
+            //the requester takes over the queue
+            requester->m_released_queue = nullptr;
+            requester->m_queue.store(q, std::memory_order_release);
+            requester->m_suspend_cond.notify_one();
+        }
+
+        //removes the pin of a thread that leaves a pinned queue
+        void unpin() {
+            if (m_pinned_queue && !m_pinned_queue->m_placement.cpu_ids.empty()) {
+                topology::set_current_thread_affinity(topology::get().cpu_ids());
+            }
+            m_pinned_queue = nullptr;
+        }
+
+        //removes a worker thread from a list
+        static void erase_worker_thread(std::vector<worker_thread*>& list, worker_thread* wt) {
+            list.erase(std::remove(list.begin(), list.end(), wt), list.end());
+        }
+
+        //returns the statistics of this thread
+        worker_thread_stats get_stats() const {
+            worker_thread_stats result;
+            result.released = m_queue.load(std::memory_order_acquire) == nullptr;
+            result.executed_job_count = (size_t)m_stats.executed_job_count.get();
+            result.stolen_job_count = (size_t)m_stats.stolen_job_count.get();
+            result.failed_steal_count = (size_t)m_stats.failed_steal_count.get();
+            result.park_count = (size_t)m_stats.park_count.get();
+            result.unpark_count = (size_t)m_stats.unpark_count.get();
+            result.parked_time = std::chrono::nanoseconds(m_stats.parked_time.get());
+            result.busy_time = std::chrono::nanoseconds(m_stats.busy_time.get());
+            return result;
+        }
+
+        friend class executor;
+        friend class _executor;
+    };
+
+
+#ifdef EXECLIB_TRACE
+    //returns the trace buffer of the current thread
+    trace_buffer* _executor::current_trace_buffer(executor* ex) {
+        if (current_executor == ex && current_worker_thread) {
+            return current_worker_thread->m_trace_buffer;
+        }
+        return ex->get_current_producer()->m_trace_buffer;
+    }
+#endif
+
+
+    //put job in queue
+    void executor::queue::put_job(job* j, size_t priority) {
+        lane& l = m_lanes[priority];
+        if (current_local_pool == &m_local_pool) {
+            m_stats.put_job_count.add_release();
+            l.jobs.push(j);
+            update_high_water_mark();
+        }
+        else {
+            m_stats.inbox_put_job_count.add_release();
+            l.inbox.push_back(j);
+            update_inbox_size(priority);
+        }
+    }
+
+
+    //returns the default options with the given thread count
+    static executor_options make_executor_options(size_t thread_count) {
+        executor_options options;
+        options.thread_count = thread_count;
+        return options;
+    }
+
+
+    //The constructor.
+    executor::executor(size_t thread_count) 
+        : executor(make_executor_options(thread_count))
+    {
+    }
+
+
+    //The constructor from options.
+    executor::executor(const executor_options& options)
+        : m_options(options)
+        , m_id(next_executor_id.fetch_add(1, std::memory_order_relaxed))
+    {
+        //check thread count
+        if (m_options.thread_count == 0) {
+            throw std::invalid_argument("thread count is 0");
+        }
+
+#ifdef EXECLIB_TRACE
+        //create the trace buffers before the worker threads, which record events in them
+        m_trace_recorder = new trace_recorder();
+#endif
+
+        //create timers
+        m_timers = new timer_queue(this);
+
+        //create threads; each thread creates its queue
+        auto startup = std::make_shared<worker_startup>(make_placements(m_options));
+        m_queues.resize(m_options.thread_count, nullptr);
+        for (size_t i = 0; i < m_options.thread_count; ++i) {
+            worker_thread* wt = new worker_thread(this, i, startup);
+            m_worker_threads.push_back(wt);
+        }
+        startup->wait_for_queues();
+
+        //compute victims for stealing
+        for (queue* q : m_queues) {
+            q->init_victims(m_queues, m_options.steal.victims);
+        }
+
+        //start executing jobs
+        startup->start();
+    }
+
+
+    //Signals all threads to stop execution, then waits for them to stop.
+    executor::~executor() {
+        //stop worker threads, then destroy the jobs they did not execute
+        stop_worker_threads();
+        discard_pending_jobs();
+
+        //delete pending timers
+        delete m_timers;
+
+        //delete queues
+        for (queue* q : m_queues) {
+            delete q;
+        }
+
+        //delete producers, after the jobs allocated from their pools are destroyed
+        for (producer* p : m_producers) {
+            delete p;
+        }
+
+#ifdef EXECLIB_TRACE
+        delete m_trace_recorder;
+#endif
+    }
+
+
+    //waits until there are no pending or running jobs
+    void executor::wait_idle() {
+        if (current_executor == this && current_worker_thread) {
+            throw std::logic_error("wait_idle invoked from a worker thread of the executor");
+        }
+
+        //the jobs are executed by the worker threads only, since jobs may expect to run on one; yield, then sleep
+        for (size_t i = 0; !is_idle(); ++i) {
+            if (i < IDLE_WAIT_YIELD_COUNT) {
+                std::this_thread::yield();
+            }
+            else {
+                std::this_thread::sleep_for(IDLE_WAIT_SLEEP_DURATION);
+            }
+        }
+    }
+
+
+    //stops the worker threads
+    void executor::shutdown(shutdown_mode mode) {
+        if (current_executor == this && current_worker_thread) {
+            throw std::logic_error("shutdown invoked from a worker thread of the executor");
+        }
+
+        //the worker threads execute the pending jobs, along with the jobs those submit
+        if (mode == shutdown_mode::drain) {
+            wait_idle();
+        }
+
+        stop_worker_threads();
+
+        //jobs left, or put after draining, are destroyed
+        discard_pending_jobs();
+    }
+
+
+    //passes an exception thrown by a job to the exception handler
+    void executor::handle_exception(std::exception_ptr e) {
+        if (m_options.exception_handler) {
+            m_options.exception_handler(std::move(e));
+        }
+    }
+
+
+    //checks if all the jobs put in queues are executed, or if there are no worker threads to execute them
+    bool executor::is_idle() const {
+        //the jobs executed are counted before the jobs put, which are never less,
+        //since the submission of a job is counted before the job is published
+        uint64_t executed_job_count = m_other_executed_job_count.load(std::memory_order_acquire);
+        {
+            std::lock_guard lock(m_worker_thread_mutex);
+            if (m_stopped) {
+                return true;
+            }
+            executed_job_count += m_exited_executed_job_count;
+            for (const worker_thread* wt : m_worker_threads) {
+                executed_job_count += wt->m_stats.executed_job_count.get_acquire();
+            }
+        }
+
+        uint64_t put_job_count = 0;
+        for (const queue* q : m_queues) {
+            put_job_count += q->get_put_job_count();
+        }
+
+        return executed_job_count == put_job_count;
+    }
+
+
+    //stops and joins all worker threads; no threads are created afterwards
+    void executor::stop_worker_threads() {
+        std::vector<worker_thread*> worker_threads;
+        std::vector<worker_thread*> exited_worker_threads;
+
+        //set the stop flags with the mutex locked, so as that no thread is released, reaped or handed a queue afterwards
+        {
+            std::lock_guard lock(m_worker_thread_mutex);
+            m_stopped = true;
+            worker_threads = m_worker_threads;
+            exited_worker_threads.swap(m_exited_worker_threads);
+            for (worker_thread* wt : worker_threads) {
+                wt->m_stop.store(true, std::memory_order_seq_cst);
+            }
+        }
+
+        //join the threads; they lock the worker thread mutex while stopping
+        for (worker_thread* wt : worker_threads) {
+            wt->join();
+        }
+
+        //the jobs executed by the stopped threads remain counted
+        {
+            std::lock_guard lock(m_worker_thread_mutex);
+            for (worker_thread* wt : worker_threads) {
+                m_exited_executed_job_count += wt->m_stats.executed_job_count.get();
+            }
+            m_worker_threads.clear();
+            m_released_worker_threads.clear();
+        }
+
+        for (worker_thread* wt : worker_threads) {
+            delete wt;
+        }
+        for (worker_thread* wt : exited_worker_threads) {
+            delete wt;
+        }
+    }
+
+
+    //destroys the jobs left in the queues
+    void executor::discard_pending_jobs() {
+        uint64_t count = 0;
+        for (queue* q : m_queues) {
+            count += q->discard_jobs();
+        }
+        m_other_executed_job_count.fetch_add(count, std::memory_order_release);
+    }
+
+
+    //replace current worker thread with another thread
+    bool executor::release_current_worker_thread() {
+        //check conditions
+        if (!current_worker_thread) {
+            throw std::logic_error("the current thread is not an executor worker thread");
+        }
+
+        executor* ex = current_executor;
+        worker_thread* wt = current_worker_thread;
+
+        //get the current queue
+        queue* q = wt->m_queue.load(std::memory_order_acquire);
+        if (!q) {
+            return false;
+        }
+
+        std::vector<worker_thread*> exited_worker_threads;
+        {
+            //lock the worker threads
+            std::lock_guard lock(ex->m_worker_thread_mutex);
+
+            //no threads are created after shutdown
+            if (ex->m_stopped) {
+                return false;
+            }
+
+            //a thread that requested the queue back takes it over, else an idle released thread
+            worker_thread* replacement_worker_thread = nullptr;
+            if (!q->m_handover_requests.empty()) {
+                replacement_worker_thread = q->m_handover_requests.front();
+                q->m_handover_requests.erase(q->m_handover_requests.begin());
+                q->m_handover_requested.store(!q->m_handover_requests.empty(), std::memory_order_release);
+                replacement_worker_thread->m_released_queue = nullptr;
+            }
+            else if (!ex->m_released_worker_threads.empty()) {
+                replacement_worker_thread = ex->m_released_worker_threads.back();
+                ex->m_released_worker_threads.pop_back();
+            }
+
+            //else create new worker thread, unless the thread limit is reached
+            else {
+                const size_t max_thread_count = ex->m_options.release.max_thread_count;
+                if (max_thread_count > 0 && ex->m_worker_threads.size() >= max_thread_count) {
+                    return false;
+                }
+            }
+
+            //make the current thread released by nullifying its queue pointer
+            wt->m_queue.store(nullptr, std::memory_order_release);
+            wt->m_released_queue = q;
+            current_local_pool = nullptr;
+
+            if (replacement_worker_thread) {
+                replacement_worker_thread->m_queue.store(q, std::memory_order_release);
+                replacement_worker_thread->m_suspend_cond.notify_one();
+            }
+            else {
+                ex->m_worker_threads.push_back(new worker_thread(ex, q));
+            }
+
+            //threads that terminated after the idle timeout are deleted outside of the lock, since they lock it when stopped
+            exited_worker_threads.swap(ex->m_exited_worker_threads);
+        }
+
+        //the released thread no longer runs on the queue's cpus, which are used by the replacement thread
+        wt->unpin();
+
+        for (worker_thread* exited_worker_thread : exited_worker_threads) {
+            delete exited_worker_thread;
+        }
+
+        return true;
+    }
+
+
+    //makes the current released thread the owner of the queue it released
+    bool executor::reacquire_current_worker_thread() {
+        //check conditions
+        if (!current_worker_thread) {
+            throw std::logic_error("the current thread is not an executor worker thread");
+        }
+
+        executor* ex = current_executor;
+        worker_thread* wt = current_worker_thread;
+        queue* q;
+
+        {
+            std::unique_lock lock(ex->m_worker_thread_mutex);
+            q = wt->m_released_queue;
+            if (!q || wt->m_queue.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            //request the queue; its owner hands it over after its current job, or when it wakes up
+            q->m_handover_requests.push_back(wt);
+            q->m_handover_requested.store(true, std::memory_order_seq_cst);
+            q->notify_listener();
+
+            while (!wt->m_queue.load(std::memory_order_acquire)) {
+                if (wt->m_stop.load(std::memory_order_acquire)) {
+                    worker_thread::erase_worker_thread(q->m_handover_requests, wt);
+                    q->m_handover_requested.store(!q->m_handover_requests.empty(), std::memory_order_release);
+                    return false;
+                }
+                wt->m_suspend_cond.wait(lock);
+            }
+        }
+
+        //the thread owns the queue again
+        current_local_pool = &q->m_local_pool;
+        q->set_current_thread_affinity();
+        wt->m_pinned_queue = q;
+        return true;
+    }
+
+
+    //executes one pending job in the current thread
+    bool executor::execute_pending_job() {
+        job* j;
+
+        //worker thread of this executor: get job from own queue, or steal jobs
+        queue* q = current_executor == this && current_worker_thread ? current_worker_thread->m_queue.load(std::memory_order_relaxed) : nullptr;
+        if (q) {
+            if (!current_worker_thread->find_job(q, j)) {
+                return false;
+            }
+        }
+
+        //other thread: steal a job, starting from a queue that depends on the thread,
+        //so as that different threads do not compete for the same queue
+        else {
+            const size_t first_queue_index = std::hash<std::thread::id>()(std::this_thread::get_id());
+            if (!worker_thread::steal_job(this, first_queue_index, j)) {
+                return false;
+            }
+        }
+
+#ifdef EXECLIB_TRACE
+        trace_buffer* const buffer = _executor::current_trace_buffer(this);
+        const size_t queue_index = q ? q->m_index : trace_buffer::NO_QUEUE;
+#endif
+        EXECLIB_TRACE_EVENT(buffer, start, j, queue_index);
+        worker_thread::execute_job(this, j);
+        EXECLIB_TRACE_EVENT(buffer, finish, j, queue_index);
+        if (q) {
+            current_worker_thread->m_stats.executed_job_count.add_release();
+        }
+        else {
+            m_other_executed_job_count.fetch_add(1, std::memory_order_release);
+        }
+        return true;
+    }
+
+
+    //returns a snapshot of the statistics
+    executor_stats executor::stats() const {
+        executor_stats result;
+
+        //worker threads
+        {
+            std::lock_guard lock(m_worker_thread_mutex);
+            for (const worker_thread* wt : m_worker_threads) {
+                result.worker_threads.push_back(wt->get_stats());
+            }
+            result.reaped_worker_thread_count = m_reaped_worker_thread_count;
+        }
+
+        //totals
+        result.worker_thread_count = result.worker_threads.size();
+        for (const worker_thread_stats& wts : result.worker_threads) {
+            result.released_worker_thread_count += wts.released ? 1 : 0;
+            result.total.executed_job_count += wts.executed_job_count;
+            result.total.stolen_job_count += wts.stolen_job_count;
+            result.total.failed_steal_count += wts.failed_steal_count;
+            result.total.park_count += wts.park_count;
+            result.total.unpark_count += wts.unpark_count;
+            result.total.parked_time += wts.parked_time;
+            result.total.busy_time += wts.busy_time;
+        }
+
+        //queues
+        for (const queue* q : m_queues) {
+            result.queues.push_back(q->get_stats());
+            result.queue_high_water_mark = std::max(result.queue_high_water_mark, result.queues.back().high_water_mark);
+        }
+
+        return result;
+    }
+
+
+#ifdef EXECLIB_TRACE
+    //writes the trace events
+    void executor::write_trace(std::ostream& stream) const {
+        m_trace_recorder->write(stream);
+    }
+#endif
+
+
+    //cancels a timer
+    bool executor::cancel_timer(const timer_handle& timer) {
+        return m_timers->cancel(timer);
+    }
+
+
+    //adds a timer
+    timer_handle executor::add_timer(timer_task* task, std::chrono::steady_clock::time_point time_point, std::chrono::steady_clock::duration period) {
+        return m_timers->add(task, time_point, period);
+    }
+
+
+    //get current thread executor
+    executor* executor::get_current_executor() {
+        return current_executor;
+    }
+
+
+    //get mutex of queue
+    std::mutex& executor::get_mutex(queue* q) {
+        return q->get_mutex();
+    }
+
+
+    //returns the local pool of a queue
+    executor::job_pool* executor::get_local_pool(queue* q) {
+        return &q->m_local_pool;
+    }
+
+
+    //returns the shared pool of a queue
+    executor::job_pool* executor::get_shared_pool(queue* q) {
+        return &q->m_shared_pool;
+    }
+
+
+    //allocate memory from pool;
+    //unsynchronized because the pool is either the current thread's local pool,
+    //or a shared pool, which is synchronized on its queue's mutex by the caller;
+    //there is no corresponding free_memory_for_job function
+    //because the memory is freed from job::delete_this.
+    void* executor::alloc_memory_for_job(job_pool* pool, size_t size) {
+        return pool->allocate(size);
+    }
+
+
+    //put job in queue
+    void executor::put_job(queue* q, job* j, job_priority priority) {
+        EXECLIB_TRACE_EVENT(_executor::current_trace_buffer(this), enqueue, j, q->m_index);
+        q->put_job(j, (size_t)priority);
+    }
+
+
+    //puts an allocated job in the current worker thread's queue, or in the current producer's next queue
+    void executor::schedule_job(job* j, job_priority priority) {
+        queue* q = current_executor == this && current_worker_thread ? current_worker_thread->m_queue.load(std::memory_order_relaxed) : nullptr;
+
+        if (!q) {
+            put_producer_job(get_current_producer(), j, priority);
+            return;
+        }
+
+        EXECLIB_TRACE_EVENT(current_worker_thread->m_trace_buffer, enqueue, j, q->m_index);
+
+        {
+            queue_scope scope(q);
+            q->put_job(j, (size_t)priority);
+        }
+
+        notify_listener(q);
+    }
+
+
+    //returns the producer of the current thread
+    executor::producer* executor::get_current_producer() {
+        //fast path: the thread puts jobs in the same executor as before
+        if (current_producer.executor_id == m_id) {
+            return current_producer.producer;
+        }
+
+        const std::thread::id thread_id = std::this_thread::get_id();
+        producer* result = nullptr;
+        {
+            std::lock_guard lock(m_producer_mutex);
+
+            //the producer created when the thread last used this executor
+            for (producer* p : m_producers) {
+                if (p->thread_id() == thread_id) {
+                    result = p;
+                    break;
+                }
+            }
+
+            //else a new producer, whose cycle contains the queues of the numa node the thread runs on, 
+            //or all the queues if there are none; producers start from different queues
+            if (!result) {
+                const unsigned node = topology::get().current_cpu().node;
+                std::vector<queue*> queues;
+                for (queue* q : m_queues) {
+                    if (q->m_placement.cpu.node == node) {
+                        queues.push_back(q);
+                    }
+                }
+                if (queues.empty()) {
+                    queues = m_queues;
+                }
+                result = new producer(thread_id, std::move(queues), m_next_queue_index.fetch_add(1, std::memory_order_relaxed));
+#ifdef EXECLIB_TRACE
+                result->m_trace_buffer = m_trace_recorder->new_producer_buffer();
+#endif
+                m_producers.push_back(result);
+            }
+        }
+
+        current_producer.executor_id = m_id;
+        current_producer.producer = result;
+        return result;
+    }
+
+
+    //returns the pool of a producer
+    executor::job_pool* executor::get_producer_pool(producer* p) {
+        return p->pool();
+    }
+
+
+    //puts a job in the producer's next queue; the queue is locked only for appending the job to its inbox
+    void executor::put_producer_job(producer* p, job* j, job_priority priority) {
+        queue* q = p->next_queue();
+
+        EXECLIB_TRACE_EVENT(p->m_trace_buffer, enqueue, j, q->m_index);
+
+        {
+            std::lock_guard lock(q->m_mutex);
+            q->put_job(j, (size_t)priority);
+        }
+
+        notify_listener(q);
+    }
+
+
+    //puts the continuation of a future job in a queue
+    void executor_internals::schedule_continuation(executor* ex, job* continuation) {
+        ex->schedule_job(continuation);
+    }
+
+
+    //returns the current worker thread's queue, for nested submissions
+    executor::queue* executor::get_local_queue() const {
+        if (current_executor != this || !current_worker_thread || m_options.nested_submission != nested_submission_policy::local) {
+            return nullptr;
+        }
+        return current_worker_thread->m_queue.load(std::memory_order_relaxed);
+    }
+
+
+    //notifies the queue listener that a new job is available
+    void executor::notify_listener(queue* q) {
+        //the owner of the queue is the current thread, which is not waiting;
+        //let an idle thread steal the job
+        if (current_local_pool == &q->m_local_pool) {
+            notify_idle_worker_thread(q);
+        }
+
+        //else notify the owner of the queue
+        else {
+            q->notify_listener();
+        }
+    }
+
+
+    //wakes up an idle worker thread, other than the owner of the given queue
+    void executor::notify_idle_worker_thread(queue* q) {
+        //fast path: no parked worker threads; 
+        //the fence orders the job's publication before reading the count
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_idle_worker_thread_count.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        //find the next parked worker thread, starting from the given queue's neighbor
+        const size_t queue_count = m_queues.size();
+        for (size_t i = 1; i < queue_count; ++i) {
+            queue* idle_queue = m_queues[(q->m_index + i) % queue_count];
+            if (idle_queue->m_eventcount.has_waiters()) {
+                idle_queue->notify_listener();
+                return;
+            }
+        }
     }
 
 
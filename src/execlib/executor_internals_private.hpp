@@ -3,20 +3,81 @@
 
 
 #include <mutex>
-#include <memory_resource>
+#include <atomic>
 #include "execlib/executor_internals.hpp"
+#include "job_memory_resource.hpp"
 
 
 namespace execlib {
 
 
+    //memory pool for jobs.
+    //Allocation and direct deallocation are done by one thread at a time:
+    //the owner thread of the queue for the local pool, or the holder of the queue's mutex for the shared pool.
+    //Other threads return memory lock-free, by pushing it to the remote free list,
+    //which is reclaimed in batch on the next allocation.
+    struct executor_internals::job_pool {
+        //returned memory block
+        struct free_block {
+            free_block* next;
+            size_t size;
+        };
+
+        //memory pool; slabs of size classes for small jobs
+        job_memory_resource m_memory_pool;
+
+        //memory returned by other threads
+        std::atomic<free_block*> m_remote_free_list{ nullptr };
+
+        //allocates memory, after reclaiming the memory returned by other threads
+        void* allocate(size_t size) {
+            reclaim();
+            return m_memory_pool.allocate_block(size);
+        }
+
+        //deallocates memory; if the current thread does not own the pool,
+        //the memory is pushed to the remote free list
+        void deallocate(void* mem, size_t size) {
+            if (this == current_local_pool) {
+                m_memory_pool.deallocate_block(mem, size);
+            }
+            else {
+                deallocate_remote(mem, size);
+            }
+        }
+
+        //pushes memory to the remote free list; lock-free
+        void deallocate_remote(void* mem, size_t size) {
+            free_block* block = new (mem) free_block{ m_remote_free_list.load(std::memory_order_relaxed), size };
+            while (!m_remote_free_list.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        //returns the memory of the remote free list to the pool;
+        //the whole list is taken at once, therefore there is no ABA problem
+        void reclaim() {
+            if (!m_remote_free_list.load(std::memory_order_relaxed)) {
+                return;
+            }
+            for (free_block* block = m_remote_free_list.exchange(nullptr, std::memory_order_acquire); block;) {
+                free_block* next = block->next;
+                m_memory_pool.deallocate_block(block, block->size);
+                block = next;
+            }
+        }
+    };
+
+
     //queue base
     struct executor_internals::queue_base {
-        //mutex of queue.
+        //mutex of queue; protects the shared pool and the inbox.
         std::mutex m_mutex;
 
-        //memory pool for queue
-        std::pmr::unsynchronized_pool_resource m_memory_pool;
+        //memory pool for jobs allocated by the owner thread of the queue; not synchronized
+        job_pool m_local_pool;
+
+        //memory pool for jobs allocated by other threads; synchronized on the queue's mutex
+        job_pool m_shared_pool;
     };
 
 
@@ -0,0 +1,162 @@
+#ifndef EXECLIB_JOB_MEMORY_RESOURCE_HPP
+#define EXECLIB_JOB_MEMORY_RESOURCE_HPP
+
+
+#include <cstddef>
+#include <new>
+#include <memory_resource>
+
+
+namespace execlib {
+
+
+    //Unsynchronized memory resource for jobs.
+    //
+    //Small blocks are allocated from slabs of fixed size classes (64, 128 and 256 bytes),
+    //tuned to typical lambda captures; blocks are cache-line aligned, and freed blocks
+    //are reused in LIFO order, so as that recently used, hot memory is reused first.
+    //Larger blocks and over-aligned blocks come from an unsynchronized pool resource.
+    class job_memory_resource : public std::pmr::memory_resource {
+    public:
+        //number of size classes
+        static constexpr size_t SIZE_CLASS_COUNT = 3;
+
+        //size of the smallest class; each next class doubles the size
+        static constexpr size_t MIN_CLASS_SIZE = 64;
+
+        //size of the largest class
+        static constexpr size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE << (SIZE_CLASS_COUNT - 1);
+
+        //size of a slab
+        static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+        //returns the size class for a size; the size must not be greater than MAX_CLASS_SIZE
+        static size_t size_class(size_t size) {
+            size_t result = 0;
+            for (size_t class_size = MIN_CLASS_SIZE; class_size < size; class_size <<= 1) {
+                ++result;
+            }
+            return result;
+        }
+
+        //returns the block size of a size class
+        static size_t class_size(size_t size_class) {
+            return MIN_CLASS_SIZE << size_class;
+        }
+
+        //frees all slabs
+        ~job_memory_resource() {
+            while (m_slabs) {
+                slab* next = m_slabs->next;
+                ::operator delete(m_slabs, std::align_val_t(MIN_CLASS_SIZE));
+                m_slabs = next;
+            }
+        }
+
+        //allocates a slab for each size class that does not have one;
+        //the memory is first touched by the current thread
+        void reserve() {
+            for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i) {
+                if (!m_size_classes[i].next) {
+                    new_slab(m_size_classes[i], class_size(i));
+                }
+            }
+        }
+
+        //allocates a block
+        void* allocate_block(size_t size, size_t alignment = alignof(std::max_align_t)) {
+            if (size > MAX_CLASS_SIZE || alignment > MIN_CLASS_SIZE) {
+                return m_large_blocks.allocate(size, alignment);
+            }
+
+            size_class_data& data = m_size_classes[size_class(size)];
+
+            //reuse the most recently freed block
+            if (data.free_list) {
+                free_block* block = data.free_list;
+                data.free_list = block->next;
+                return block;
+            }
+
+            //next block from the current slab, or a new slab
+            if (data.next == data.end) {
+                new_slab(data, class_size(size_class(size)));
+            }
+            void* result = data.next;
+            data.next += class_size(size_class(size));
+            return result;
+        }
+
+        //deallocates a block
+        void deallocate_block(void* mem, size_t size, size_t alignment = alignof(std::max_align_t)) {
+            if (size > MAX_CLASS_SIZE || alignment > MIN_CLASS_SIZE) {
+                m_large_blocks.deallocate(mem, size, alignment);
+                return;
+            }
+
+            size_class_data& data = m_size_classes[size_class(size)];
+            data.free_list = new (mem) free_block{ data.free_list };
+        }
+
+    protected:
+        //memory resource interface
+        void* do_allocate(size_t size, size_t alignment) override {
+            return allocate_block(size, alignment);
+        }
+
+        //memory resource interface
+        void do_deallocate(void* mem, size_t size, size_t alignment) override {
+            deallocate_block(mem, size, alignment);
+        }
+
+        //memory resource interface
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        //free block of a size class
+        struct free_block {
+            free_block* next;
+        };
+
+        //header of a slab; it occupies the first block of the slab
+        struct slab {
+            slab* next;
+        };
+
+        //data of a size class
+        struct size_class_data {
+            //freed blocks
+            free_block* free_list = nullptr;
+
+            //next unused block of the current slab
+            char* next = nullptr;
+
+            //end of the current slab
+            char* end = nullptr;
+        };
+
+        //size classes
+        size_class_data m_size_classes[SIZE_CLASS_COUNT];
+
+        //all slabs
+        slab* m_slabs = nullptr;
+
+        //blocks that do not fit a size class
+        std::pmr::unsynchronized_pool_resource m_large_blocks;
+
+        //allocates a new slab for a size class
+        void new_slab(size_class_data& data, size_t block_size) {
+            char* mem = static_cast<char*>(::operator new(SLAB_SIZE, std::align_val_t(MIN_CLASS_SIZE)));
+            m_slabs = new (mem) slab{ m_slabs };
+            data.next = mem + block_size;
+            data.end = mem + SLAB_SIZE;
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_JOB_MEMORY_RESOURCE_HPP
@@ -0,0 +1,235 @@
+#ifndef EXECLIB_TIMING_WHEEL_HPP
+#define EXECLIB_TIMING_WHEEL_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace execlib {
+
+
+    //A hierarchical timing wheel (Varghese and Lauck).
+    //
+    //Time is measured in ticks; there are LEVEL_COUNT levels of SLOT_COUNT slots each.
+    //A node is kept at the lowest level whose slots span its tick, given the current tick;
+    //when the current tick crosses the boundary of a higher level slot, the nodes of that slot
+    //are redistributed to the lower levels. Nodes beyond the highest level are kept in an overflow list.
+    //
+    //Insertion and removal are O(1); advancing jumps directly to the next occupied slot.
+    //
+    //It is not synchronized.
+    class timing_wheel {
+    public:
+        //bits per level
+        static constexpr unsigned LEVEL_BITS = 8;
+
+        //number of slots per level
+        static constexpr size_t SLOT_COUNT = size_t(1) << LEVEL_BITS;
+
+        //number of levels
+        static constexpr size_t LEVEL_COUNT = 4;
+
+        //a node of the wheel; it is linked in a circular list
+        struct node {
+            //list links
+            node* prev = this;
+            node* next = this;
+
+            //the tick the node expires on
+            uint64_t tick = 0;
+
+            //level and slot of the node, for updating the occupancy bitmap on removal
+            uint16_t level = 0;
+            uint16_t slot = 0;
+
+            //checks if the node is in the wheel
+            bool linked() const { return next != this; }
+        };
+
+        //constructor
+        timing_wheel(uint64_t current_tick = 0) : m_current_tick(current_tick) {}
+
+        timing_wheel(const timing_wheel&) = delete;
+        timing_wheel& operator = (const timing_wheel&) = delete;
+
+        //returns the current tick
+        uint64_t current_tick() const { return m_current_tick; }
+
+        //returns the number of nodes
+        size_t size() const { return m_size; }
+
+        //inserts a node; nodes for past ticks expire on the next tick
+        void insert(node* n, uint64_t tick) {
+            n->tick = tick > m_current_tick ? tick : m_current_tick + 1;
+            link(n);
+            ++m_size;
+        }
+
+        //removes a node
+        void remove(node* n) {
+            unlink(n);
+            --m_size;
+        }
+
+        //returns the next tick that has work: either the tick of a level 0 slot that has nodes,
+        //or the start of the next occupied higher level slot, where its nodes are redistributed;
+        //there is nothing to do before that tick
+        uint64_t next_tick() const {
+            for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+                //nodes of a level are after the current tick's slot, since they would be at a lower level otherwise
+                const size_t next_index = next_occupied_slot(level, slot_index(m_current_tick, level) + 1);
+                if (next_index < SLOT_COUNT) {
+                    const unsigned shift = LEVEL_BITS * (unsigned)(level + 1);
+                    const uint64_t upper = shift < 64 ? (m_current_tick >> shift) << shift : 0;
+                    return upper | (uint64_t(next_index) << (LEVEL_BITS * level));
+                }
+            }
+
+            //the start of the next overflow period
+            const unsigned shift = LEVEL_BITS * (unsigned)LEVEL_COUNT;
+            return ((m_current_tick >> shift) + 1) << shift;
+        }
+
+        //advances the wheel up to the given tick; expired(node*) is invoked for each expired node,
+        //after the node is removed from the wheel; expired may insert nodes
+        template <class F> void advance(uint64_t tick, F&& expired) {
+            while (m_current_tick < tick) {
+                //nothing to do
+                if (m_size == 0) {
+                    m_current_tick = tick;
+                    return;
+                }
+
+                //skip ticks without work
+                const uint64_t next = next_tick();
+                if (next > tick) {
+                    m_current_tick = tick;
+                    return;
+                }
+                m_current_tick = next;
+
+                //redistribute the nodes of higher levels, highest level first
+                if ((next & ((uint64_t(1) << (LEVEL_BITS * LEVEL_COUNT)) - 1)) == 0) {
+                    relink_list(m_overflow);
+                }
+                for (size_t level = LEVEL_COUNT - 1; level > 0; --level) {
+                    if ((next & ((uint64_t(1) << (LEVEL_BITS * level)) - 1)) == 0) {
+                        relink_list(m_slots[level][slot_index(next, level)]);
+                    }
+                }
+
+                //expire the nodes of the current tick
+                node& slot = m_slots[0][slot_index(next, 0)];
+                while (slot.linked()) {
+                    node* n = slot.next;
+                    remove(n);
+                    expired(n);
+                }
+            }
+        }
+
+    private:
+        //current tick; all ticks up to and including it are processed
+        uint64_t m_current_tick;
+
+        //number of nodes
+        size_t m_size = 0;
+
+        //slots; each one is the head of a circular list
+        node m_slots[LEVEL_COUNT][SLOT_COUNT];
+
+        //nodes beyond the highest level
+        node m_overflow;
+
+        //occupancy bitmaps of slots
+        uint64_t m_bitmaps[LEVEL_COUNT][SLOT_COUNT / 64] = {};
+
+        //returns the slot index of a tick at the given level
+        static size_t slot_index(uint64_t tick, size_t level) {
+            return (size_t)((tick >> (LEVEL_BITS * level)) & (SLOT_COUNT - 1));
+        }
+
+        //returns the first occupied slot of a level, starting from the given index, or SLOT_COUNT
+        size_t next_occupied_slot(size_t level, size_t index) const {
+            while (index < SLOT_COUNT) {
+                const uint64_t bits = m_bitmaps[level][index / 64] >> (index % 64);
+                if (bits) {
+                    size_t offset = 0;
+                    for (uint64_t b = bits; !(b & 1); b >>= 1) {
+                        ++offset;
+                    }
+                    return index + offset;
+                }
+                index = (index / 64 + 1) * 64;
+            }
+            return SLOT_COUNT;
+        }
+
+        //links a node to the slot of its tick
+        void link(node* n) {
+            node* head = &m_overflow;
+            n->level = (uint16_t)LEVEL_COUNT;
+
+            //the lowest level where the tick and the current tick share the upper digits
+            for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+                if ((n->tick >> (LEVEL_BITS * (level + 1))) == (m_current_tick >> (LEVEL_BITS * (level + 1)))) {
+                    n->level = (uint16_t)level;
+                    n->slot = (uint16_t)slot_index(n->tick, level);
+                    head = &m_slots[level][n->slot];
+                    m_bitmaps[level][n->slot / 64] |= uint64_t(1) << (n->slot % 64);
+                    break;
+                }
+            }
+
+            n->prev = head->prev;
+            n->next = head;
+            head->prev->next = n;
+            head->prev = n;
+        }
+
+        //unlinks a node from its slot
+        void unlink(node* n) {
+            n->prev->next = n->next;
+            n->next->prev = n->prev;
+            if (n->level < LEVEL_COUNT && !m_slots[n->level][n->slot].linked()) {
+                m_bitmaps[n->level][n->slot / 64] &= ~(uint64_t(1) << (n->slot % 64));
+            }
+            n->prev = n;
+            n->next = n;
+        }
+
+        //links the nodes of a list again, according to the current tick
+        void relink_list(node& head) {
+            node list;
+            if (!head.linked()) {
+                return;
+            }
+
+            //move the nodes to a temporary list, then link them
+            list.next = head.next;
+            list.prev = head.prev;
+            list.next->prev = &list;
+            list.prev->next = &list;
+            head.next = &head;
+            head.prev = &head;
+            if (&head != &m_overflow) {
+                const size_t level = (size_t)(&head - &m_slots[0][0]) / SLOT_COUNT;
+                const size_t slot = (size_t)(&head - &m_slots[0][0]) % SLOT_COUNT;
+                m_bitmaps[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+            }
+
+            while (list.linked()) {
+                node* n = list.next;
+                n->prev->next = n->next;
+                n->next->prev = n->prev;
+                link(n);
+            }
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_TIMING_WHEEL_HPP
@@ -0,0 +1,191 @@
+#include <cctype>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include "topology.hpp"
+#ifdef __linux__
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+
+namespace execlib {
+
+
+#ifdef __linux__
+
+
+    //reads the first number of a sysfs file, which may contain a single number or a cpu list like "0-3,8"
+    static bool read_first_number(const std::string& path, unsigned& value) {
+        std::ifstream file(path);
+        return (bool)(file >> value);
+    }
+
+
+    //parses a cpu list like "0-3,8-11"
+    static std::vector<unsigned> parse_cpu_list(const std::string& list) {
+        std::vector<unsigned> result;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            const size_t end = std::min(list.find(',', pos), list.size());
+            const std::string range = list.substr(pos, end - pos);
+            const size_t dash = range.find('-');
+            try {
+                const unsigned first = (unsigned)std::stoul(range.substr(0, dash));
+                const unsigned last = dash == std::string::npos ? first : (unsigned)std::stoul(range.substr(dash + 1));
+                for (unsigned id = first; id <= last; ++id) {
+                    result.push_back(id);
+                }
+            }
+            catch (...) {
+            }
+            pos = end + 1;
+        }
+        return result;
+    }
+
+
+    //detects the cpus from sysfs
+    static std::vector<topology::cpu> detect_cpus() {
+        std::vector<topology::cpu> result;
+
+        const std::string root = "/sys/devices/system/cpu/";
+
+        std::string online;
+        std::ifstream(root + "online") >> online;
+
+        for (const unsigned id : parse_cpu_list(online)) {
+            const std::string cpu_path = root + "cpu" + std::to_string(id) + "/";
+            topology::cpu c{ id, id, 0, 0 };
+
+            //core: package and core id
+            unsigned package = 0, core = 0;
+            if (read_first_number(cpu_path + "topology/physical_package_id", package) && read_first_number(cpu_path + "topology/core_id", core)) {
+                c.core = (package << 16) | core;
+            }
+
+            //L3: the first cpu that shares the cache; if there is no L3, the package
+            c.l3 = package;
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(cpu_path + "cache", ec)) {
+                unsigned level = 0;
+                if (read_first_number(entry.path().string() + "/level", level) && level == 3) {
+                    read_first_number(entry.path().string() + "/shared_cpu_list", c.l3);
+                    break;
+                }
+            }
+
+            //numa node: the cpu directory contains a nodeN link
+            for (const auto& entry : std::filesystem::directory_iterator(cpu_path, ec)) {
+                const std::string name = entry.path().filename().string();
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::isdigit((unsigned char)name[4])) {
+                    c.node = (unsigned)std::stoul(name.substr(4));
+                    break;
+                }
+            }
+
+            result.push_back(c);
+        }
+
+        return result;
+    }
+
+
+#else
+
+
+    //detection not supported
+    static std::vector<topology::cpu> detect_cpus() {
+        return {};
+    }
+
+
+#endif
+
+
+    //detects the topology
+    topology::topology() : m_cpus(detect_cpus()) {
+        //fallback: every cpu is a core; all of them share one L3 and one node
+        if (m_cpus.empty()) {
+            const unsigned count = std::max(std::thread::hardware_concurrency(), 1u);
+            for (unsigned id = 0; id < count; ++id) {
+                m_cpus.push_back(cpu{ id, id, 0, 0 });
+            }
+        }
+    }
+
+
+    //returns the topology of the machine
+    const topology& topology::get() {
+        static const topology t;
+        return t;
+    }
+
+
+    //returns the cpu with the given id
+    topology::cpu topology::cpu_with_id(unsigned id) const {
+        for (const cpu& c : m_cpus) {
+            if (c.id == id) {
+                return c;
+            }
+        }
+        return cpu{ id, id, id, 0 };
+    }
+
+
+    //returns the ids of all cpus
+    std::vector<unsigned> topology::cpu_ids() const {
+        std::vector<unsigned> result;
+        for (const cpu& c : m_cpus) {
+            result.push_back(c.id);
+        }
+        return result;
+    }
+
+
+    //returns the cpu the current thread runs on
+    topology::cpu topology::current_cpu() const {
+#if defined(__linux__)
+        const int id = sched_getcpu();
+        return id >= 0 ? cpu_with_id((unsigned)id) : m_cpus.front();
+#elif defined(_WIN32)
+        return cpu_with_id((unsigned)GetCurrentProcessorNumber());
+#else
+        return m_cpus.front();
+#endif
+    }
+
+
+    //pins the current thread to the given cpus
+    bool topology::set_current_thread_affinity(const std::vector<unsigned>& cpu_ids) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const unsigned id : cpu_ids) {
+            if (id < CPU_SETSIZE) {
+                CPU_SET(id, &set);
+            }
+        }
+        return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (const unsigned id : cpu_ids) {
+            if (id < sizeof(DWORD_PTR) * 8) {
+                mask |= DWORD_PTR(1) << id;
+            }
+        }
+        return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+        (void)cpu_ids;
+        return false;
+#endif
+    }
+
+
+} //namespace execlib
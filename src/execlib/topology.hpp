@@ -0,0 +1,62 @@
+#ifndef EXECLIB_TOPOLOGY_HPP
+#define EXECLIB_TOPOLOGY_HPP
+
+
+#include <cstddef>
+#include <vector>
+
+
+namespace execlib {
+
+
+    //cpu topology of the machine; used to prefer nearby threads
+    class topology {
+    public:
+        //a logical cpu
+        struct cpu {
+            //operating system id of the cpu
+            unsigned id;
+
+            //id of the physical core the cpu belongs to
+            unsigned core;
+
+            //id of the L3 cache the cpu shares with other cpus
+            unsigned l3;
+
+            //id of the numa node of the cpu
+            unsigned node;
+        };
+
+        //returns the topology of the machine; detected on first call
+        static const topology& get();
+
+        //returns the logical cpus
+        const std::vector<cpu>& cpus() const { return m_cpus; }
+
+        //returns the cpu assumed to run the thread of the queue with the given index, for threads that are not pinned
+        const cpu& cpu_for(size_t index) const { return m_cpus[index % m_cpus.size()]; }
+
+        //returns the cpu with the given operating system id; if there is no such cpu, a cpu without siblings is returned
+        cpu cpu_with_id(unsigned id) const;
+
+        //returns the ids of all cpus
+        std::vector<unsigned> cpu_ids() const;
+
+        //returns the cpu the current thread runs on; if it is not supported, the first cpu is returned
+        cpu current_cpu() const;
+
+        //pins the current thread to the given cpus; returns false if it fails or if it is not supported
+        static bool set_current_thread_affinity(const std::vector<unsigned>& cpu_ids);
+
+    private:
+        std::vector<cpu> m_cpus;
+
+        //detects the topology; if detection is not supported, all cpus share one L3 and one node
+        topology();
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_TOPOLOGY_HPP
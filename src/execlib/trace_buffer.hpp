@@ -0,0 +1,166 @@
+#ifndef EXECLIB_TRACE_BUFFER_HPP
+#define EXECLIB_TRACE_BUFFER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+
+//number of events kept per trace buffer; a power of two
+#ifndef EXECLIB_TRACE_EVENT_COUNT
+#define EXECLIB_TRACE_EVENT_COUNT 16384
+#endif
+
+
+//records a trace event in a buffer, if tracing is enabled; otherwise, it compiles to nothing,
+//and its arguments are not evaluated
+#ifdef EXECLIB_TRACE
+#define EXECLIB_TRACE_EVENT(buffer, type, job, queue_index) (buffer)->record(trace_buffer::event_type::type, (job), (queue_index))
+#else
+#define EXECLIB_TRACE_EVENT(buffer, type, job, queue_index) ((void)0)
+#endif
+
+
+namespace execlib {
+
+
+    //returns a timestamp for trace events, in ticks of the cheapest monotonic clock:
+    //the time stamp counter on x86, the virtual counter on arm64, else the steady clock;
+    //ticks are converted to time when the events are exported
+    inline uint64_t trace_clock_ticks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+
+    //Ring buffer of trace events, with a single writer thread; when it is full, the oldest events are overwritten.
+    //
+    //Recording an event takes a timestamp and a few relaxed stores; there are no locks
+    //and no read-modify-write operations. The buffer can be read by any thread while it is written:
+    //the writer claims an event before writing it, and the reader drops the events
+    //that were claimed again, therefore possibly overwritten, while it copied them.
+    class trace_buffer {
+    public:
+        //number of events
+        static constexpr size_t CAPACITY = EXECLIB_TRACE_EVENT_COUNT;
+
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "EXECLIB_TRACE_EVENT_COUNT must be a power of two");
+
+        //queue index of events that do not refer to a queue
+        static constexpr uint32_t NO_QUEUE = UINT32_MAX;
+
+        //type of event
+        enum class event_type : uint8_t {
+            //a job was put in a queue; the queue index is the destination
+            enqueue,
+
+            //a job was stolen; the queue index is the victim
+            steal,
+
+            //a job started executing; the queue index is the one of the executing thread
+            start,
+
+            //a job finished executing; the queue index is the one of the executing thread
+            finish
+        };
+
+        //an event
+        struct event {
+            uint64_t ticks;
+            uintptr_t job;
+            event_type type;
+            uint32_t queue_index;
+        };
+
+        //constructor
+        trace_buffer(std::string name) : m_name(std::move(name)), m_slots(new slot[CAPACITY]) {}
+
+        trace_buffer(const trace_buffer&) = delete;
+        trace_buffer& operator = (const trace_buffer&) = delete;
+
+        //returns the name of the buffer; it is the name of its track in the exported trace
+        const std::string& name() const { return m_name; }
+
+        //records an event; it must only be invoked from the writer thread
+        void record(event_type type, const void* job, size_t queue_index) {
+            const uint64_t index = m_end.load(std::memory_order_relaxed);
+
+            //claim the event, before overwriting it
+            m_begin.store(index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot& s = m_slots[index & (CAPACITY - 1)];
+            s.ticks.store(trace_clock_ticks(), std::memory_order_relaxed);
+            s.job.store((uintptr_t)job, std::memory_order_relaxed);
+            s.info.store((uint64_t)type | ((uint64_t)(uint32_t)queue_index << 8), std::memory_order_relaxed);
+
+            //publish the event
+            m_end.store(index + 1, std::memory_order_release);
+        }
+
+        //appends the events of the buffer to the given vector, oldest first
+        void copy_events(std::vector<event>& events) const {
+            const uint64_t end = m_end.load(std::memory_order_acquire);
+            const uint64_t first = end > CAPACITY ? end - CAPACITY : 0;
+            const size_t offset = events.size();
+
+            for (uint64_t index = first; index < end; ++index) {
+                const slot& s = m_slots[index & (CAPACITY - 1)];
+                const uint64_t info = s.info.load(std::memory_order_relaxed);
+                events.push_back(event{ s.ticks.load(std::memory_order_relaxed), (uintptr_t)s.job.load(std::memory_order_relaxed), (event_type)(info & 0xFF), (uint32_t)(info >> 8) });
+            }
+
+            //drop the events that the writer claimed again while they were copied
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t begin = m_begin.load(std::memory_order_relaxed);
+            const uint64_t valid_first = begin > CAPACITY ? begin - CAPACITY : 0;
+            if (valid_first > first) {
+                const size_t count = (size_t)std::min(valid_first - first, end - first);
+                events.erase(events.begin() + offset, events.begin() + offset + count);
+            }
+        }
+
+    private:
+        //storage of an event; atomic, since it can be read while it is overwritten
+        struct slot {
+            std::atomic<uint64_t> ticks{ 0 };
+            std::atomic<uint64_t> job{ 0 };
+            std::atomic<uint64_t> info{ 0 };
+        };
+
+        //name of the buffer
+        const std::string m_name;
+
+        //events
+        const std::unique_ptr<slot[]> m_slots;
+
+        //number of events claimed by the writer
+        std::atomic<uint64_t> m_begin{ 0 };
+
+        //number of events recorded
+        std::atomic<uint64_t> m_end{ 0 };
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_TRACE_BUFFER_HPP
@@ -0,0 +1,211 @@
+#ifndef EXECLIB_WORK_STEALING_DEQUE_HPP
+#define EXECLIB_WORK_STEALING_DEQUE_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+
+
+namespace execlib {
+
+
+    /**
+     * A lock-free work-stealing deque (Chase-Lev).
+     *
+     * The owner thread pushes and pops values at the bottom of the deque;
+     * any other thread can steal values from the top of the deque.
+     *
+     * The implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models"
+     * (Le, Pop, Cohen, Zappa Nardelli, 2013).
+     *
+     * Buffers replaced due to growth are kept until the deque is destroyed,
+     * because thieves might still be reading from them.
+     *
+     * @param T type of value; it must be trivially copyable.
+     */
+    template <class T> class work_stealing_deque {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    public:
+        /**
+         * The constructor.
+         * @param capacity initial capacity; it must be a power of 2.
+         */
+        work_stealing_deque(size_t capacity = 256)
+            : m_array(new array(capacity, nullptr))
+        {
+        }
+
+        /**
+         * Deletes the current buffer and all previous buffers.
+         */
+        ~work_stealing_deque() {
+            array* a = m_array.load(std::memory_order_relaxed);
+            while (a) {
+                array* prev = a->prev;
+                delete a;
+                a = prev;
+            }
+        }
+
+        /**
+         * Checks if the deque is empty.
+         * The result is exact only when invoked from the owner thread.
+         * @return true if empty, false otherwise.
+         */
+        bool empty() const {
+            const int64_t b = m_bottom.load(std::memory_order_relaxed);
+            const int64_t t = m_top.load(std::memory_order_acquire);
+            return b <= t;
+        }
+
+        /**
+         * Returns the approximate number of values in the deque.
+         * @return the approximate number of values in the deque.
+         */
+        size_t size() const {
+            const int64_t b = m_bottom.load(std::memory_order_relaxed);
+            const int64_t t = m_top.load(std::memory_order_acquire);
+            return b > t ? (size_t)(b - t) : 0;
+        }
+
+        /**
+         * Pushes a value at the bottom of the deque.
+         * It must only be invoked from the owner thread.
+         * @param value value to push.
+         */
+        void push(T value) {
+            const int64_t b = m_bottom.load(std::memory_order_relaxed);
+            const int64_t t = m_top.load(std::memory_order_acquire);
+            array* a = m_array.load(std::memory_order_relaxed);
+
+            //grow the buffer if full
+            if (b - t > (int64_t)a->mask) {
+                a = grow(a, t, b);
+            }
+
+            a->store(b, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Pops a value from the bottom of the deque.
+         * It must only be invoked from the owner thread.
+         * @param value the popped value.
+         * @return true if a value was popped, false if the deque was empty.
+         */
+        bool pop(T& value) {
+            const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+            array* a = m_array.load(std::memory_order_relaxed);
+            m_bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = m_top.load(std::memory_order_relaxed);
+
+            //empty deque
+            if (t > b) {
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            value = a->load(b);
+
+            //more than one value; no race with thieves
+            if (t < b) {
+                return true;
+            }
+
+            //last value; race against thieves for it
+            const bool result = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return result;
+        }
+
+        /**
+         * Steals a value from the top of the deque.
+         * It can be invoked from any thread.
+         * @param value the stolen value.
+         * @return true if a value was stolen, false if the deque was empty
+         *  or another thread won the race for the value.
+         */
+        bool steal(T& value) {
+            int64_t t = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b = m_bottom.load(std::memory_order_acquire);
+
+            //empty deque
+            if (t >= b) {
+                return false;
+            }
+
+            //acquire instead of consume, since consume is promoted to acquire anyway
+            array* a = m_array.load(std::memory_order_acquire);
+            value = a->load(t);
+
+            return m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque& operator = (const work_stealing_deque&) = delete;
+
+    private:
+        //circular buffer
+        struct array {
+            //capacity - 1; capacity is a power of 2
+            const size_t mask;
+
+            //slots
+            std::atomic<T>* const slots;
+
+            //previous buffer, kept around for thieves that still read from it
+            array* const prev;
+
+            //constructor
+            array(size_t capacity, array* p)
+                : mask(capacity - 1), slots(new std::atomic<T>[capacity]), prev(p)
+            {
+            }
+
+            //destructor
+            ~array() {
+                delete[] slots;
+            }
+
+            //load value from slot
+            T load(int64_t index) const {
+                return slots[(size_t)index & mask].load(std::memory_order_relaxed);
+            }
+
+            //store value to slot
+            void store(int64_t index, T value) {
+                slots[(size_t)index & mask].store(value, std::memory_order_relaxed);
+            }
+        };
+
+        //top index; modified by thieves
+        alignas(64) std::atomic<int64_t> m_top{ 0 };
+
+        //bottom index; modified by the owner
+        alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+
+        //current buffer
+        alignas(64) std::atomic<array*> m_array;
+
+        //replace the buffer with one of double capacity
+        array* grow(array* a, int64_t t, int64_t b) {
+            array* new_array = new array((a->mask + 1) * 2, a);
+            for (int64_t i = t; i < b; ++i) {
+                new_array->store(i, a->load(i));
+            }
+            m_array.store(new_array, std::memory_order_release);
+            return new_array;
+        }
+    };
+
+
+} //namespace execlib
+
+
+#endif //EXECLIB_WORK_STEALING_DEQUE_HPP
@@ -1,90 +1,14 @@
 #include <string>
 #include <vector>
-#include <random>
 #include <algorithm>
 #include <chrono>
-#include <iostream>
+#include <stdexcept>
+#include <future>
+#include <sstream>
 #include <condition_variable>
 #include "execlib.hpp"
 
 
-template <class F> double time_func(F&& func) {
-    auto start = std::chrono::high_resolution_clock::now();
-    func();
-    auto end = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
-}
-
-
-static std::vector<std::string> prepare_test_data() {
-    std::random_device rd;
-    std::default_random_engine re(rd());
-    std::uniform_int_distribution<int> dist(' ', '~');
-
-    std::vector<std::string> result;
-
-    for (size_t i = 0; i < std::thread::hardware_concurrency()*100; ++i) {
-        result.emplace_back();
-        for (size_t j = 0; j < 8; ++j) {
-            result.back().push_back((char)dist(re));
-        }
-    }
-
-    return result;
-}
-
-
-static void create_all_combinations(const std::string& in_str, std::string& out_str, size_t position = 0) {
-    if (position < in_str.size()) {
-        for (size_t i = 0; i < in_str.size(); ++i) {
-            out_str[position] = in_str[i];
-            create_all_combinations(in_str, out_str,position + 1);
-        }
-    }
-}
-
-
-static void test(execlib::executor& executor) {
-    const auto test_data = prepare_test_data();
-    const size_t partition_size = test_data.size() / executor.thread_count();
-    const size_t partition_count = (test_data.size() + partition_size - 1) / partition_size;
-
-    //std::vector<execlib::future<bool>> events(partition_count);
-    execlib::counter<int> counter;
-
-    for (size_t partition_index = 0; partition_index < partition_count; ++partition_index) {
-        const size_t partition_start = partition_index * partition_size;
-        const size_t partition_end = partition_index < partition_count - 1 ? partition_start + partition_size : test_data.size();
-
-        counter.increment_and_notify_one();
-        executor.execute([partition_test_data = std::vector<std::string>(test_data.begin() + partition_start, test_data.begin() + partition_end), pi = partition_index/*, &events*/, &counter, partition_start, partition_end]() {
-            printf("partioning data from %zi to %zi\n", partition_start, partition_end);
-            for (size_t index = 0; index < partition_test_data.size(); ++index) {
-                const std::string& in_str = partition_test_data[index];
-                std::string out_str(in_str);
-                create_all_combinations(in_str, out_str);
-            }
-            //events[pi].set_and_notify_one(true);
-            counter.decrement_and_notify_one();
-        });
-    }
-
-    /*
-    for (execlib::future<bool>& e : events) {
-        e.wait();
-    }
-    */
-    counter.wait();
-}
-
-
-static void performance_test() {
-    static execlib::executor executor;
-    double d = time_func([&]() { test(executor); });
-    std::cout << d << std::endl;
-}
-
-
 using test_mutex = execlib::deadlock_free_mutex;
 //using test_mutex = std::mutex;
 
@@ -124,6 +48,31 @@ static void mutex_test() {
 }
 
 
+static void lock_all_test() {
+    execlib::deadlock_free_mutex mutexA;
+    execlib::deadlock_free_mutex mutexB;
+    size_t value = 0;
+
+    std::thread thread1([&]() {
+        for (size_t i = 0; i < 10000; ++i) {
+            execlib::lock_all_guard lock(mutexA, mutexB);
+            ++value;
+        }
+    });
+    std::thread thread2([&]() {
+        for (size_t i = 0; i < 10000; ++i) {
+            execlib::lock_all_guard lock(mutexB, mutexA);
+            ++value;
+        }
+    });
+    thread1.join();
+    thread2.join();
+
+    const execlib::deadlock_free_mutex_stats stats = mutexA.stats();
+    printf("lock_all: value = %zi, contended locks = %zi\n", value, stats.contended_lock_count);
+}
+
+
 static void release_worker_thread_test() {
     execlib::executor executor(1);
     execlib::counter counter(2);
@@ -151,10 +100,547 @@ static void release_worker_thread_test() {
 }
 
 
+static void reacquire_worker_thread_test() {
+    execlib::executor_options options;
+    options.thread_count = 1;
+    options.release.max_thread_count = 2;
+    options.release.idle_timeout = std::chrono::milliseconds(50);
+    execlib::executor executor(options);
+    execlib::counter counter(2);
+
+    executor.execute([&]() {
+        execlib::executor::release_current_worker_thread();
+        const bool released_again = execlib::executor::release_current_worker_thread();
+        executor.execute([&]() {
+            printf("job executed by the replacement thread\n");
+            counter.decrement_and_notify_one();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const bool reacquired = execlib::executor::reacquire_current_worker_thread();
+        printf("released again: %i, reacquired: %i\n", released_again, reacquired);
+        counter.decrement_and_notify_one();
+    });
+
+    counter.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const execlib::executor_stats stats = executor.stats();
+    printf("worker threads: %zi, reaped: %zi\n", stats.worker_thread_count, stats.reaped_worker_thread_count);
+}
+
+
+static void execute_bulk_test() {
+    execlib::executor executor(2);
+    execlib::counter<int> counter(10);
+    std::atomic<size_t> sum{ 0 };
+
+    executor.execute_n(10, [&](size_t index) {
+        sum += index;
+        counter.decrement_and_notify_one();
+    });
+
+    counter.wait();
+    printf("execute_n sum = %zi\n", sum.load());
+}
+
+
+static void producer_test() {
+    execlib::executor executor1(2);
+    execlib::executor executor2(2);
+    std::atomic<size_t> executed1{ 0 };
+    std::atomic<size_t> executed2{ 0 };
+    std::vector<std::thread> producers;
+
+    //threads that are not worker threads alternate between executors
+    for (size_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&]() {
+            for (size_t i = 0; i < 1000; ++i) {
+                executor1.execute([&]() { ++executed1; });
+                executor2.execute([&]() { ++executed2; });
+            }
+            executor1.execute(execlib::use_future, [&]() { ++executed1; }).get();
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    executor1.wait_idle();
+    executor2.wait_idle();
+    printf("producer jobs executed = %zi, %zi\n", executed1.load(), executed2.load());
+}
+
+
+static void parallel_algorithms_test() {
+    execlib::executor executor(2);
+    std::vector<size_t> values(10000);
+
+    execlib::parallel_for(executor, size_t(0), values.size(), [&](size_t index) {
+        values[index] = index;
+    });
+
+    const size_t sum = execlib::parallel_reduce(executor, values.begin(), values.end(), size_t(0), 
+        [](size_t value) { return value; }, 
+        [](size_t a, size_t b) { return a + b; });
+
+    printf("parallel_reduce sum = %zi\n", sum);
+
+    std::vector<size_t> squares(values.size());
+    execlib::parallel_transform(executor, values.begin(), values.end(), squares.begin(), [](size_t value) { return value * value; });
+
+    std::vector<size_t> prefix_sums(values.size());
+    execlib::parallel_scan(executor, values.begin(), values.end(), prefix_sums.begin(), size_t(0), [](size_t a, size_t b) { return a + b; });
+
+    printf("parallel_transform last = %zi, parallel_scan last = %zi\n", squares.back(), prefix_sums.back());
+
+    std::vector<std::string> strings(values.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        strings[i] = std::to_string((i * 7919) % strings.size());
+    }
+    std::vector<std::string> expected(strings);
+    std::sort(expected.begin(), expected.end());
+    execlib::parallel_sort(executor, strings.begin(), strings.end(), size_t(64), std::less<std::string>());
+
+    printf("parallel_sort sorted = %s\n", strings == expected ? "true" : "false");
+}
+
+
+static void future_test() {
+    execlib::executor executor(2);
+
+    auto result = executor.execute(execlib::use_future, []() { return 21; })
+        .then([](int value) { return value * 2; });
+
+    printf("future result = %i\n", result.get());
+}
+
+
+static void task_group_test() {
+    execlib::executor executor(2);
+    execlib::task_group group(executor);
+    const execlib::cancellation_token token = group.token();
+    std::atomic<int> executed{ 0 };
+
+    for (int i = 0; i < 1000; ++i) {
+        group.run([&, token]() {
+            if (token.is_cancelled()) {
+                return;
+            }
+            if (++executed == 10) {
+                group.cancel();
+            }
+        });
+    }
+
+    group.wait();
+    printf("task group: %i jobs executed before cancellation\n", executed.load());
+}
+
+
+static void task_graph_test() {
+    execlib::executor executor(2);
+    execlib::task_graph graph(executor);
+    std::mutex order_mutex;
+    std::string order;
+
+    auto step = [&](char c) {
+        return [&, c]() {
+            std::lock_guard lock(order_mutex);
+            order.push_back(c);
+        };
+    };
+
+    //a -> (b, c) -> d
+    execlib::task_graph::node& a = graph.add(step('a'));
+    execlib::task_graph::node& b = graph.add(step('b'));
+    execlib::task_graph::node& c = graph.add(step('c'));
+    execlib::task_graph::node& d = graph.add(step('d'));
+    a.precede(b).precede(c);
+    d.succeed(b).succeed(c);
+
+    for (int i = 0; i < 3; ++i) {
+        graph.run_and_wait();
+        order.push_back(' ');
+    }
+    printf("task graph order = %s\n", order.c_str());
+}
+
+
+static void strand_test() {
+    execlib::executor executor(4);
+    std::vector<size_t> sequences[4];
+    std::atomic<bool> inside{ false };
+    std::atomic<size_t> overlap_count{ 0 };
+
+    //jobs submitted by the same producer execute in order, one at a time, without a mutex
+    {
+        execlib::strand strand(executor);
+        executor.execute_n(4, [&](size_t producer) {
+            for (size_t i = 0; i < 1000; ++i) {
+                strand.execute([&, producer, i]() {
+                    if (inside.exchange(true)) {
+                        ++overlap_count;
+                    }
+                    sequences[producer].push_back(i);
+                    inside = false;
+                });
+            }
+        });
+        executor.wait_idle();
+    }
+
+    size_t in_order_count = 0;
+    for (const std::vector<size_t>& sequence : sequences) {
+        in_order_count += sequence.size() == 1000 && std::is_sorted(sequence.begin(), sequence.end()) ? 1 : 0;
+    }
+    printf("strand: %zi sequences in order, %zi overlaps\n", in_order_count, overlap_count.load());
+}
+
+
+static void exception_test() {
+    std::atomic<int> handled{ 0 };
+    execlib::executor_options options;
+    options.thread_count = 2;
+    options.exception_handler = [&](std::exception_ptr) { ++handled; };
+    execlib::executor executor(options);
+
+    executor.execute([]() { throw std::runtime_error("job"); });
+
+    auto result = executor.execute(execlib::use_future, []() -> int { throw std::runtime_error("future"); });
+    try {
+        result.get();
+    }
+    catch (const std::runtime_error& e) {
+        printf("future exception: %s\n", e.what());
+    }
+
+    execlib::task_group group(executor);
+    group.run([]() { throw std::runtime_error("task group"); });
+    try {
+        group.wait();
+    }
+    catch (const std::runtime_error& e) {
+        printf("task group exception: %s\n", e.what());
+    }
+
+    //the element throws in a forked job, which processes the upper half of the range
+    try {
+        execlib::parallel_for(executor, size_t(0), size_t(1000), size_t(10), [](size_t index) {
+            if (index == 999) {
+                throw std::runtime_error("parallel_for");
+            }
+        });
+    }
+    catch (const std::runtime_error& e) {
+        printf("parallel_for exception: %s\n", e.what());
+    }
+
+    try {
+        execlib::parallel_reduce(executor, size_t(0), size_t(1000), size_t(10), 0,
+            [](size_t index) -> int { if (index == 999) throw std::runtime_error("parallel_reduce"); return 1; },
+            [](int a, int b) { return a + b; });
+    }
+    catch (const std::runtime_error& e) {
+        printf("parallel_reduce exception: %s\n", e.what());
+    }
+
+    executor.wait_idle();
+    printf("handled exceptions: %i\n", handled.load());
+}
+
+
+static void priority_test() {
+    execlib::executor executor(1);
+    execlib::counter<int> counter(16);
+    std::atomic<bool> blocked{ true };
+    std::mutex order_mutex;
+    std::string order;
+
+    //block the only worker thread, until all jobs are submitted
+    executor.execute([&]() {
+        while (blocked.load()) {
+            std::this_thread::yield();
+        }
+        counter.decrement_and_notify_one();
+    });
+
+    const std::pair<execlib::job_priority, char> jobs[] = {
+        { execlib::job_priority::background, 'b' },
+        { execlib::job_priority::normal, 'n' },
+        { execlib::job_priority::high, 'h' }
+    };
+    for (const auto& job : jobs) {
+        for (size_t i = 0; i < 5; ++i) {
+            executor.execute([&, c = job.second]() {
+                {
+                    std::lock_guard lock(order_mutex);
+                    order.push_back(c);
+                }
+                counter.decrement_and_notify_one();
+            }, job.first);
+        }
+    }
+
+    blocked = false;
+    counter.wait();
+    printf("priority order = %s\n", order.c_str());
+}
+
+
+static void timer_test() {
+    execlib::executor executor(2);
+    execlib::counter<int> counter(4);
+    std::atomic<int> periodic_count{ 0 };
+    const auto start = std::chrono::steady_clock::now();
+
+    executor.execute_after(std::chrono::milliseconds(20), [&]() {
+        counter.decrement_and_notify_one();
+    });
+
+    const execlib::timer_handle cancelled = executor.execute_after(std::chrono::milliseconds(10), [&]() {
+        printf("cancelled timer fired\n");
+    });
+    executor.cancel_timer(cancelled);
+
+    //the counter must not go past zero before the waiter wakes up
+    const execlib::timer_handle periodic = executor.execute_every(std::chrono::milliseconds(5), [&]() {
+        if (++periodic_count <= 3) {
+            counter.decrement_and_notify_one();
+        }
+    });
+
+    counter.wait();
+    executor.cancel_timer(periodic);
+    printf("timers fired in %lli ms\n", (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+
+//recursive fork-join sum; waiting jobs execute their children
+static size_t fork_join_sum(execlib::executor& executor, size_t first, size_t last) {
+    if (last - first <= 16) {
+        size_t sum = 0;
+        for (size_t i = first; i < last; ++i) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    const size_t middle = first + (last - first) / 2;
+    execlib::counter<int> pending(1);
+    size_t left;
+    executor.execute([&]() {
+        left = fork_join_sum(executor, first, middle);
+        pending.decrement_and_notify_one();
+    });
+    const size_t right = fork_join_sum(executor, middle, last);
+    pending.wait(executor);
+    return left + right;
+}
+
+
+static void counter_wait_test() {
+    execlib::executor executor(1);
+    execlib::counter<int> done(1);
+    size_t sum;
+
+    executor.execute([&]() {
+        sum = fork_join_sum(executor, 0, 10000);
+        done.decrement_and_notify_one();
+    });
+
+    done.wait(executor);
+    printf("fork-join sum on one thread: %zi\n", sum);
+}
+
+
+static void latch_barrier_test() {
+    execlib::executor executor(4);
+    execlib::atomic_counter<int> counter(4);
+    execlib::latch latch(4);
+    std::atomic<int> phase_count{ 0 };
+    execlib::barrier barrier(4, [&]() { ++phase_count; });
+
+    executor.execute_n(4, [&](size_t) {
+        for (int i = 0; i < 10; ++i) {
+            barrier.arrive_and_wait();
+        }
+        latch.count_down();
+        counter.decrement_and_notify_all();
+    });
+
+    latch.wait();
+    counter.wait();
+    printf("barrier phases: %i\n", phase_count.load());
+}
+
+
+static void shutdown_test() {
+    std::atomic<int> executed{ 0 };
+
+    {
+        execlib::executor executor(2);
+        executor.execute_n(100, [&](size_t) {
+            executor.execute([&]() { ++executed; });
+        });
+        executor.wait_idle();
+        printf("executed after wait_idle: %i\n", executed.load());
+
+        executor.execute_n(100, [&](size_t) { ++executed; });
+        executor.shutdown(execlib::shutdown_mode::drain);
+        printf("executed after drain: %i\n", executed.load());
+    }
+
+    {
+        execlib::executor executor(1);
+        std::atomic<bool> started{ false };
+        executor.execute([&]() {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        });
+        while (!started) {
+            std::this_thread::yield();
+        }
+        executor.execute_n(100, [&](size_t) { ++executed; });
+        auto result = executor.execute(execlib::use_future, [&]() { return ++executed; })
+            .then([&](int value) { ++executed; return value; });
+        executor.shutdown(execlib::shutdown_mode::discard);
+        printf("executed after discard: %i\n", executed.load());
+        try {
+            result.get();
+        }
+        catch (const std::future_error& e) {
+            printf("discarded future: %s\n", e.code() == std::future_errc::broken_promise ? "broken promise" : e.what());
+        }
+    }
+
+    {
+        //the graph is discarded while its first node runs
+        execlib::executor executor(1);
+        execlib::task_graph graph(executor);
+        std::atomic<bool> started{ false };
+        std::atomic<int> node_count{ 0 };
+        auto& a = graph.add([&]() {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            ++node_count;
+        });
+        auto& b = graph.add([&]() { ++node_count; });
+        auto& c = graph.add([&]() { ++node_count; });
+        auto& d = graph.add([&]() { ++node_count; });
+        a.precede(b).precede(c);
+        d.succeed(b).succeed(c);
+        graph.run();
+        while (!started) {
+            std::this_thread::yield();
+        }
+        executor.shutdown(execlib::shutdown_mode::discard);
+        graph.wait();
+        printf("task graph completed after discard: %s\n", node_count.load() < 4 ? "true" : "false");
+    }
+}
+
+
+static void stats_test() {
+    execlib::executor executor(2);
+    execlib::counter<int> counter(100);
+
+    executor.execute_n(100, [&](size_t) {
+        counter.decrement_and_notify_one();
+    });
+
+    counter.wait();
+    const execlib::executor_stats stats = executor.stats();
+    printf("stats: %zi worker threads, %zi jobs executed, %zi jobs stolen, queue high water mark %zi\n", 
+        stats.worker_thread_count, stats.total.executed_job_count, stats.total.stolen_job_count, stats.queue_high_water_mark);
+}
+
+
+#ifdef EXECLIB_TRACE
+static void trace_test() {
+    execlib::executor executor(2);
+    executor.execute_n(100, [](size_t) {});
+    executor.wait_idle();
+
+    //every job is a slice of a worker thread track
+    std::ostringstream stream;
+    executor.write_trace(stream);
+    const std::string trace = stream.str();
+    size_t slice_count = 0;
+    for (size_t pos = trace.find("\"ph\":\"B\""); pos != std::string::npos; pos = trace.find("\"ph\":\"B\"", pos + 1)) {
+        ++slice_count;
+    }
+    printf("traced jobs = %zi\n", slice_count);
+}
+#endif
+
+
+#ifdef EXECLIB_HAS_COROUTINES
+//coroutine that starts immediately and destroys itself when done
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+
+static detached_task produce(execlib::executor& executor, execlib::counter<int>& produced) {
+    co_await executor.schedule();
+    produced.decrement_and_notify_all();
+}
+
+
+static detached_task consume(execlib::executor& executor, execlib::counter<int>& produced, execlib::counter<int>& done) {
+    co_await executor.schedule(execlib::job_priority::high);
+    co_await produced;
+    done.decrement_and_notify_one();
+}
+
+
+static void coroutine_test() {
+    execlib::executor executor(2);
+    execlib::counter<int> produced(100);
+    execlib::counter<int> done(10);
+
+    for (int i = 0; i < 10; ++i) {
+        consume(executor, produced, done);
+    }
+    for (int i = 0; i < 100; ++i) {
+        produce(executor, produced);
+    }
+
+    done.wait();
+    printf("coroutines resumed\n");
+}
+#endif
+
+
 int main() {
-    performance_test();
     release_worker_thread_test();
+    reacquire_worker_thread_test();
+    execute_bulk_test();
+    producer_test();
+    parallel_algorithms_test();
+    future_test();
+    task_group_test();
+    exception_test();
+    task_graph_test();
+    strand_test();
+    priority_test();
+    timer_test();
+    stats_test();
+#ifdef EXECLIB_TRACE
+    trace_test();
+#endif
+    shutdown_test();
+    counter_wait_test();
+    latch_barrier_test();
+#ifdef EXECLIB_HAS_COROUTINES
+    coroutine_test();
+#endif
+    lock_all_test();
     mutex_test();
-    system("pause");
     return 0;
 }